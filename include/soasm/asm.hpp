@@ -3,23 +3,256 @@
 #define SOASM_ASM_HPP
 
 #include "instr.hpp"
+#include "symbols.hpp"
+#include "util/overloaded.hpp"
 #include <iostream>
 #include <format>
+#include <string>
+#include <iterator>
 #include <variant>
+#include <tuple>
+#include <optional>
+#include <array>
+#include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 namespace SOASM{
+	using listing_t=std::vector<std::tuple<size_t,std::span<uint8_t>,std::string>>;
+
+	//write instruction at pc as "Name opts... args", return pc of next instruction
+	template<typename InstrSet,typename Out>
+	static size_t format_instr_at(Out& out,std::span<uint8_t> data,size_t pc){
+		std::visit([&]<typename T>(T instr){
+			auto arg_raws=T::args_t::from_bytes(data.subspan(pc+InstrSet::raw::size));
+			std::apply([&](auto name,auto... opts){
+				out=std::format_to(out,"{}",name);
+				((out=std::format_to(out," {}",opts)),...);
+			},instr.format_args());
+			out=std::format_to(out," {}",arg_raws);
+			pc+=T::size;
+		},InstrSet::get_instr(data.subspan(pc)));
+		return pc;
+	}
+	//decode one instruction at pc into ret, return pc of next instruction
+	//with symbols, the text ends with a comment naming the symbol the instruction is in
+	template<typename InstrSet>
+	static size_t disassemble_at(std::span<uint8_t> data,size_t pc,size_t start_addr,listing_t& ret,
+								 const SymbolIndex* symbols=nullptr){
+		std::string text;
+		auto out=std::back_inserter(text);
+		auto next=format_instr_at<InstrSet>(out,data,pc);
+		if(auto match=symbols?symbols->lookup(start_addr+pc):std::nullopt){
+			SymbolIndex::format_to(std::format_to(out," ;"),*match);
+		}
+		ret.emplace_back(start_addr+pc,data.subspan(pc,next-pc),std::move(text));
+		return next;
+	}
 	template<typename InstrSet>
-	static auto disassemble(std::span<uint8_t> data,size_t start_addr=0){
-		std::vector<std::tuple<size_t,std::span<uint8_t>,std::string>> ret;
-		for (size_t pc = 0; pc < data.size(); ++pc) {
-			std::visit([&]<typename T>(T instr){
-				auto arg_raws=T::args_t::from_bytes(data.subspan(pc+InstrSet::raw::size));
-				ret.emplace_back(start_addr+pc,data.subspan(pc,T::size),std::format("{} {}",instr.to_string(),arg_raws));
-				pc+=T::args_t::size;
-			},InstrSet::get_instr(data.subspan(pc)));
+	static auto disassemble(std::span<uint8_t> data,size_t start_addr=0,const SymbolIndex* symbols=nullptr){
+		listing_t ret;
+		for (size_t pc = 0; pc < data.size();) {
+			pc=disassemble_at<InstrSet>(data,pc,start_addr,ret,symbols);
 		}
 		return ret;
 	}
+	//Write the listing of data to out in the syntax Parser reads, so it assembles again.
+	//Symbols are written as "name:" lines at their address, symbols inside an instruction as "; name = addr" comments,
+	//as a label there would move when assembled again. Every instruction ends with a comment of its address and
+	//symbol. Lines are formatted straight into out.
+	template<typename InstrSet,typename Out>
+	static Out write_listing(Out out,std::span<uint8_t> data,size_t start_addr=0,const SymbolIndex& symbols={}){
+		auto sym=symbols.lower_bound(start_addr);
+		auto put_symbols=[&](size_t addr){//symbols up to addr
+			for(;sym<symbols.size() && symbols.addr(sym)<=addr;++sym){
+				out=symbols.addr(sym)==addr?std::format_to(out,"{}:\n",symbols.name(sym))
+										   :std::format_to(out,"; {} = {:#06x}\n",symbols.name(sym),symbols.addr(sym));
+			}
+		};
+		for (size_t pc = 0; pc < data.size();) {
+			auto addr=start_addr+pc;
+			put_symbols(addr);
+			out=std::format_to(out,"\t");
+			pc=format_instr_at<InstrSet>(out,data,pc);
+			out=std::format_to(out," ;{:04x}",addr);
+			if(auto match=symbols.lookup(addr)){
+				out=SymbolIndex::format_to(std::format_to(out," "),*match);
+			}
+			*out++='\n';
+		}
+		put_symbols(start_addr+data.size());
+		return out;
+	}
+	//Same output as disassemble, chunks are decoded in parallel.
+	//Chunk boundaries may fall inside an instruction, so every chunk is also decoded speculatively from each
+	//offset an instruction could end at, until that decoding meets an instruction start of the main one.
+	template<typename InstrSet>
+	static auto disassemble_parallel(std::span<uint8_t> data,size_t start_addr=0,
+									 size_t threads=std::thread::hardware_concurrency(),size_t min_chunk=1uz<<14,
+									 const SymbolIndex* symbols=nullptr){
+		static constexpr size_t max_size=InstrSet::max_size;
+		struct Stream{
+			listing_t list{};
+			size_t sync=0;//index in main stream where this one joins it, or list.size() of main if never
+			size_t end=0;//pc after last instruction
+		};
+		struct Chunk{
+			size_t begin,end;
+			std::array<Stream,max_size> streams{};//decoded from begin+offset
+		};
+		threads=std::max<size_t>(threads,1);
+		auto chunk_size=std::max(min_chunk,(data.size()+threads*4-1)/(threads*4));
+		std::vector<Chunk> chunks;
+		for(size_t begin=0;begin<data.size();begin+=chunk_size){
+			chunks.push_back({begin,std::min(begin+chunk_size,data.size())});
+		}
+
+		std::atomic<size_t> next{0};
+		auto worker=[&]{
+			for(size_t i;(i=next.fetch_add(1,std::memory_order_relaxed))<chunks.size();){
+				auto& [begin,end,streams]=chunks[i];
+				auto& main=streams[0];
+				std::vector<bool> starts(end-begin,false);
+				for(main.end=begin;main.end<end;){
+					starts[main.end-begin]=true;
+					main.end=disassemble_at<InstrSet>(data,main.end,start_addr,main.list,symbols);
+				}
+				for(size_t offset=1;offset<max_size && i>0 && begin+offset<end;++offset){
+					auto& stream=streams[offset];
+					for(stream.end=begin+offset;stream.end<end && !starts[stream.end-begin];){
+						stream.end=disassemble_at<InstrSet>(data,stream.end,start_addr,stream.list,symbols);
+					}
+					if(stream.end<end){//joined main stream
+						stream.sync=std::ranges::lower_bound(main.list,start_addr+stream.end,{},
+															 [](auto& e){return std::get<0>(e);})-main.list.begin();
+						stream.end=main.end;
+					}else{
+						stream.sync=main.list.size();
+					}
+				}
+			}
+		};
+		{
+			std::vector<std::jthread> pool;
+			for(size_t i=1;i<std::min(threads,chunks.size());++i){
+				pool.emplace_back(worker);
+			}
+			worker();
+		}
+
+		listing_t ret;
+		size_t pc=0;
+		for(auto& [begin,end,streams]:chunks){
+			if(pc>=end){//previous instruction covers the whole chunk
+				continue;
+			}
+			auto& main=streams[0];
+			auto& stream=streams[pc-begin];
+			std::ranges::move(stream.list,std::back_inserter(ret));
+			if(&stream!=&main){
+				std::move(main.list.begin()+stream.sync,main.list.end(),std::back_inserter(ret));
+			}
+			pc=stream.end;
+		}
+		return ret;
+	}
+	//Code split into instructions and labels, args are kept unresolved so it can be rewritten and encoded again.
+	//Code must contain only instructions and labels, and opcodes must not be lazy.
+	template<typename InstrSet>
+	struct Decoded{
+		using instr_ts=InstrSet::instr_ts;
+		using raw=InstrSet::raw;
+		struct Instr{
+			instr_ts instr;
+			std::vector<Code::val_type> args{};
+
+			template<typename T,typename ...Args>
+			static Instr make(T instr,Args... args){
+				Code code;
+				(code.add(args.may_lazys()),...);
+				return {instr.template set_id<InstrSet>(),std::move(code.codes)};
+			}
+			[[nodiscard]] size_t size() const{
+				return std::visit([]<typename T>(const T&){return T::size;},instr);
+			}
+			//value of the arg bytes, if none of them is lazy
+			[[nodiscard]] std::optional<uintmax_t> value(size_t begin,size_t size) const{
+				std::array<uint8_t,sizeof(uintmax_t)> bytes{};
+				for(size_t i=0;i<size;++i){
+					auto byte=std::get_if<uint8_t>(&args[begin+i]);
+					if(!byte){
+						return std::nullopt;
+					}
+					bytes[i]=*byte;
+				}
+				return RawTypes::LE::u64::from_bytes(bytes);
+			}
+			//label referenced by all arg bytes in [begin,begin+size), as Label::lazy() does
+			[[nodiscard]] bool refers(const Label& label,size_t begin,size_t size) const{
+				for(size_t i=0;i<size;++i){
+					auto lazy=std::get_if<Lazy>(&args[begin+i]);
+					if(!lazy || lazy->ptr!=label.ptr || lazy->kind!=Lazy::Kind::Absolute || lazy->offset!=8*i){
+						return false;
+					}
+				}
+				return size>0;
+			}
+		};
+		using item_t=std::variant<Label,Instr>;
+
+		std::vector<item_t> items{};
+
+		static Decoded decode(const Code& code){
+			Decoded ret;
+			for(auto it=code.begin();it!=code.end();){
+				if(auto label=std::get_if<Label>(&*it)){
+					ret.items.emplace_back(*label);
+					++it;
+					continue;
+				}
+				std::array<uint8_t,raw::size> op;
+				for(auto& byte:op){
+					auto v=it==code.end()?nullptr:std::get_if<uint8_t>(&*it);
+					if(!v){
+						throw std::invalid_argument("opcode is not a plain byte");
+					}
+					byte=*v;
+					++it;
+				}
+				auto instr=InstrSet::get_instr(op);
+				auto args_size=std::visit([]<typename T>(const T&){return T::args_t::size;},instr);
+				if(static_cast<size_t>(code.end()-it)<args_size){
+					throw std::invalid_argument("instruction truncated");
+				}
+				ret.items.emplace_back(Instr{instr,std::vector<Code::val_type>(it,it+args_size)});
+				it+=args_size;
+			}
+			return ret;
+		}
+		[[nodiscard]] Code to_code() const{
+			Code code;
+			for(const auto& item:items){
+				std::visit(Util::overloaded{
+					[&](const Label& label){code.add(label);},
+					[&](const Instr& instr){
+						code.add(std::visit([](const auto& v){return raw::to_bytes(v.to_raw());},instr.instr));
+						code.codes.insert(code.codes.end(),instr.args.begin(),instr.args.end());
+					},
+				},item);
+			}
+			return code;
+		}
+		[[nodiscard]] size_t size() const{
+			size_t sum=0;
+			for(const auto& item:items){
+				if(auto instr=std::get_if<Instr>(&item)){
+					sum+=instr->size();
+				}
+			}
+			return sum;
+		}
+	};
 	struct CodeBlock{
 		Label start;
 		Code body{};
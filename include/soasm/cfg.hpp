@@ -0,0 +1,144 @@
+#ifndef SOASM_CFG_HPP
+#define SOASM_CFG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <variant>
+#include <algorithm>
+
+namespace SOASM{
+	enum struct Flow:uint8_t{
+		Next,//continue with next instruction
+		Jump,//go to target
+		Branch,//go to target or next
+		Call,//go to target, then next
+		CallIndirect,//go to unknown address, then next
+		Return,
+		Stop,
+	};
+	struct FlowInfo{
+		Flow kind=Flow::Next;
+		std::optional<size_t> target{};
+		[[nodiscard]] bool falls_through() const{
+			return kind==Flow::Next||kind==Flow::Branch||kind==Flow::Call||kind==Flow::CallIndirect;
+		}
+	};
+
+	//Control flow graph recovered by following control transfers from the entry points,
+	//bytes never reached as code are classified as data.
+	//The instruction set provides `FlowInfo flow(const T& instr,const T::args_t::raws_t& args)`, found by ADL.
+	template<typename InstrSet>
+	struct CFG{
+		enum struct Byte:uint8_t{
+			Data,
+			Instr,//first byte of instruction
+			Arg,//other bytes of instruction
+		};
+		struct Block{
+			size_t begin,end;//addresses
+			FlowInfo exit;//flow of last instruction
+			std::vector<size_t> succ{};//begin addresses of successor blocks
+		};
+
+		size_t start_addr=0;
+		std::vector<Byte> bytes{};
+		std::vector<Block> blocks{};//sorted by begin
+		std::vector<size_t> overlapping{};//sorted addresses reached as code inside an instruction decoded before
+
+		static std::pair<FlowInfo,size_t> decode(std::span<uint8_t> data,size_t pc){
+			return std::visit([&]<typename T>(T instr)->std::pair<FlowInfo,size_t>{
+				if(pc+T::size>data.size()){
+					return {{Flow::Stop},data.size()-pc};
+				}
+				auto args=T::args_t::from_bytes(data.subspan(pc+InstrSet::raw::size));
+				return {flow(instr,args),T::size};
+			},InstrSet::get_instr(data.subspan(pc)));
+		}
+		static CFG build(std::span<uint8_t> data,std::span<const size_t> entries,size_t start_addr=0){
+			CFG cfg{start_addr,std::vector<Byte>(data.size(),Byte::Data)};
+			std::vector<uint8_t> leader(data.size(),false),control(data.size(),false);
+			std::vector<size_t> work;
+			auto in_image=[&](std::optional<size_t> addr){
+				return addr && *addr>=start_addr && *addr-start_addr<data.size();
+			};
+			auto add_leader=[&](size_t pc){
+				if(!leader[pc]){
+					leader[pc]=true;
+					work.push_back(pc);
+				}
+			};
+			for(auto entry:entries){
+				if(in_image(entry)){
+					add_leader(entry-start_addr);
+				}
+			}
+			while(!work.empty()){
+				size_t pc=work.back();
+				work.pop_back();
+				while(cfg.bytes[pc]!=Byte::Instr){
+					auto [info,size]=decode(data,pc);
+					//an instruction starting in or running into one decoded before is not decoded, the first one stays
+					if(std::any_of(cfg.bytes.begin()+pc,cfg.bytes.begin()+pc+size,[](Byte b){return b!=Byte::Data;})){
+						cfg.overlapping.push_back(start_addr+pc);
+						break;
+					}
+					cfg.bytes[pc]=Byte::Instr;
+					std::fill_n(cfg.bytes.begin()+pc+1,size-1,Byte::Arg);
+					control[pc]=info.kind!=Flow::Next;
+					if(in_image(info.target)){
+						add_leader(*info.target-start_addr);
+					}
+					if(!info.falls_through() || pc+size>=data.size()){
+						break;
+					}
+					if(info.kind!=Flow::Next){
+						add_leader(pc+size);
+						break;
+					}
+					pc+=size;
+				}
+			}
+			std::ranges::sort(cfg.overlapping);
+			cfg.overlapping.erase(std::ranges::unique(cfg.overlapping).begin(),cfg.overlapping.end());
+			for(size_t pc=0;pc<data.size();){
+				if(cfg.bytes[pc]!=Byte::Instr){
+					++pc;
+					continue;
+				}
+				Block block{start_addr+pc};
+				for(;;){
+					auto last=pc;
+					do{++pc;}while(pc<data.size() && cfg.bytes[pc]==Byte::Arg);
+					if(control[last] || pc>=data.size() || cfg.bytes[pc]!=Byte::Instr || leader[pc]){
+						block.exit=decode(data,last).first;
+						break;
+					}
+				}
+				block.end=start_addr+pc;
+				if(in_image(block.exit.target)){
+					block.succ.push_back(*block.exit.target);
+				}
+				if(block.exit.falls_through() && pc<data.size() && cfg.bytes[pc]==Byte::Instr){
+					block.succ.push_back(block.end);
+				}
+				cfg.blocks.push_back(std::move(block));
+			}
+			return cfg;
+		}
+		//block containing addr
+		[[nodiscard]] const Block* find(size_t addr) const{
+			auto it=std::ranges::upper_bound(blocks,addr,{},&Block::begin);
+			if(it==blocks.begin() || addr>=std::prev(it)->end){
+				return nullptr;
+			}
+			return &*std::prev(it);
+		}
+		[[nodiscard]] bool is_code(size_t addr) const{
+			return addr>=start_addr && addr-start_addr<bytes.size() && bytes[addr-start_addr]!=Byte::Data;
+		}
+	};
+}
+#endif //SOASM_CFG_HPP
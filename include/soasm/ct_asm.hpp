@@ -0,0 +1,149 @@
+#ifndef SOASM_CT_ASM_HPP
+#define SOASM_CT_ASM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <concepts>
+#include <initializer_list>
+#include "instr.hpp"
+
+//constexpr assembler, program is written as a function of Assembler and assembled into std::array at compile time
+//	constexpr auto rom=SOASM::CT::assemble<InstrSet,[](auto& a){
+//		auto end=a.label();
+//		a(ImmVal{},0);
+//		a(BranchZero{},end);
+//		a.bind(end);
+//		a(Halt{});
+//	}>();
+//undefined or redefined labels are reported as compile errors
+namespace SOASM::CT{
+	struct Label{
+		size_t id;
+	};
+	struct Offset{//same as SOASM::Label::offset(), relative to the address of the byte being written
+		Label label;
+	};
+
+	template<typename InstrSet>
+	struct Assembler{
+		struct Fixup{
+			size_t pos;
+			Label label;
+			size_t size;
+			bool is_big_endian;
+			bool relative;
+		};
+		size_t start;
+		std::vector<uint8_t> bytes{};
+		std::vector<std::optional<size_t>> labels{};
+		std::vector<Fixup> fixups{};
+
+		constexpr explicit Assembler(size_t start=0):start(start){}
+
+		constexpr Label label(){
+			labels.emplace_back();
+			return {labels.size()-1};
+		}
+		constexpr Label label(size_t addr){
+			labels.emplace_back(addr);
+			return {labels.size()-1};
+		}
+		constexpr Assembler& bind(Label label){
+			if(labels[label.id]){
+				throw std::logic_error("label defined twice");
+			}
+			labels[label.id]=start+bytes.size();
+			return *this;
+		}
+		constexpr Assembler& data(std::initializer_list<uint8_t> values){
+			bytes.insert(bytes.end(),values.begin(),values.end());
+			return *this;
+		}
+		constexpr Assembler& fill(size_t addr,uint8_t padding=0xff){
+			if(addr<start+bytes.size()){
+				throw std::logic_error("fill address before current address");
+			}
+			bytes.resize(addr-start,padding);
+			return *this;
+		}
+
+		template<typename Instr,typename ...Args>
+		constexpr Assembler& operator()(const Instr& instr,Args... args){
+			using args_t=Instr::args_t;
+			static_assert(sizeof...(Args)==args_t::num,"wrong number of arguments");
+			put<typename Instr::raw>(instr.template set_id<InstrSet>().pack());
+			[&]<size_t ...I>(std::index_sequence<I...>){
+				(put<typename args_t::template raw<I>>(args),...);
+			}(std::make_index_sequence<args_t::num>{});
+			return *this;
+		}
+
+		//resolve all label references, must be called after the whole program is written
+		constexpr std::vector<uint8_t>& finish(){
+			for(auto& [pos,label,size,is_big_endian,relative]:fixups){
+				if(!labels[label.id]){
+					throw std::logic_error("label used but never defined");
+				}
+				for(size_t i=0;i<size;++i){
+					uintmax_t v=*labels[label.id];
+					if(relative){//mirror Lazy: every byte is relative to itself
+						v-=pos+i;
+					}
+					bytes[pos+i]=byte_of(v,i,size,is_big_endian);
+				}
+			}
+			fixups.clear();
+			return bytes;
+		}
+
+	private:
+		static constexpr uint8_t byte_of(uintmax_t v,size_t i,size_t size,bool is_big_endian){
+			return static_cast<uint8_t>((v>>(8*(is_big_endian?size-i-1:i)))&0xff);
+		}
+		template<typename Raw>
+		constexpr void put(std::integral auto v){
+			for(size_t i=0;i<Raw::size;++i){
+				bytes.push_back(byte_of(static_cast<uintmax_t>(v),i,Raw::size,Raw::is_big_endian));
+			}
+		}
+		template<typename Raw>
+		constexpr void put(Label label,bool relative=false){
+			fixups.emplace_back(bytes.size(),label,Raw::size,Raw::is_big_endian,relative);
+			bytes.resize(bytes.size()+Raw::size);
+		}
+		template<typename Raw>
+		constexpr void put(Offset offset){
+			put<Raw>(offset.label,true);
+		}
+	};
+
+	template<typename InstrSet,auto Program,size_t Start=0>
+	constexpr auto assemble(){
+		constexpr auto build=[]{
+			Assembler<InstrSet> assembler{Start};
+			Program(assembler);
+			return assembler.finish();
+		};
+		constexpr size_t N=build().size();
+		std::array<uint8_t,N> ret{};
+		std::ranges::copy(build(),ret.begin());
+		return ret;
+	}
+
+	//pad assembled bytes to a full memory image
+	template<size_t Size,size_t N>
+	constexpr std::array<uint8_t,Size> image(const std::array<uint8_t,N>& bytes,uint8_t padding=0xff){
+		static_assert(N<=Size,"program larger than image");
+		std::array<uint8_t,Size> ret{};
+		std::ranges::fill(ret,padding);
+		std::ranges::copy(bytes,ret.begin());
+		return ret;
+	}
+} // SOASM::CT
+
+#endif //SOASM_CT_ASM_HPP
@@ -30,8 +30,6 @@ namespace SOASM{
 		}
 	};
 
-	static inline Code instr_to_code(auto instr,const data_t& arg);
-
 	template<typename Raw,typename Instr,typename ...Args>
 	struct InstrBase{
 		using raw = Raw;
@@ -44,13 +42,13 @@ namespace SOASM{
 		};
 
 		template<typename InstrSet>
-		Instr set_id(){
-			Instr instr=*static_cast<Instr*>(this);
+		constexpr Instr set_id() const{
+			Instr instr=*static_cast<const Instr*>(this);
 			instr.id=InstrSet::template get_id<Instr>();
 			return instr;
 		}
 		raw_t to_raw() const{
-			return std::bit_cast<raw_t>(*this);
+			return std::bit_cast<raw_t>(*static_cast<const Instr*>(this));
 		}
 		static Instr from_bytes(std::span<uint8_t,raw::size> data){
 			return std::bit_cast<Instr>(static_cast<raw_t>(Raw::from_bytes(data)));
@@ -4,10 +4,13 @@
 
 #include <cstddef>
 #include <bit>
+#include <limits>
 #include <algorithm>
 #include <functional>
+#include <format>
 #include "magic_enum.hpp"
 #include <ranges>
+#include "metrics.hpp"
 
 namespace SOASM::InstrSetUtil{
 	template<typename T> requires requires(T v){{std::to_string(v)};}
@@ -18,6 +21,15 @@ namespace SOASM::InstrSetUtil{
 	std::string opt_string(T opt){
 		return std::string(magic_enum::enum_name(opt));
 	}
+	//opt as a value std::format prints like opt_string
+	template<typename T>
+	auto opt_format(T opt){
+		if constexpr (std::is_enum_v<T>){
+			return magic_enum::enum_name(opt);
+		}else{
+			return +opt;
+		}
+	}
 	template<typename T>
 	static constexpr size_t opt_width(){
 		if constexpr (std::is_enum_v<T>){
@@ -27,6 +39,20 @@ namespace SOASM::InstrSetUtil{
 			return sizeof(T)*CHAR_BIT;
 		}
 	}
+	//low opt_width bits set, shifting by the full width of uintmax_t would be undefined
+	template<typename T>
+	static constexpr uintmax_t opt_mask(){
+		return opt_width<T>()>=std::numeric_limits<uintmax_t>::digits?~uintmax_t{0}:(uintmax_t{1}<<opt_width<T>())-1;
+	}
+
+	template<typename T>
+	constexpr uintmax_t opt_bits(T opt){
+		if constexpr (std::is_enum_v<T>){
+			return static_cast<uintmax_t>(std::to_underlying(opt));
+		}else{
+			return static_cast<uintmax_t>(opt)&opt_mask<T>();
+		}
+	}
 
 	template<typename T>
 	static constexpr size_t instr_count(){
@@ -50,6 +76,8 @@ namespace SOASM::InstrSetUtil{
 		using raw=Unknown::raw;
 		using raw_t=raw::type;
 		using instr_ts=std::variant<Unknown,T...>;
+		using record_ts=std::variant<typename Unknown::Record,typename T::Record...>;
+		static constexpr size_t max_size=std::max({Unknown::size,T::size...});
 		static constexpr auto get_reserved_ids(){
 			std::vector<std::pair<size_t,size_t>> reserved_ids;
 			([&]<typename V>(V){
@@ -87,9 +115,9 @@ namespace SOASM::InstrSetUtil{
 			}
 		}
 		template<typename U>
-		static size_t get_id(){
+		static constexpr size_t get_id(){
 			if constexpr(has_reserved_id<U>){
-				return U::reserve_id;
+				return U::reserve_id>>U::optw;
 			}
 			return get_id_impl<U,T...>(0)>>U::optw;
 		}
@@ -99,7 +127,8 @@ namespace SOASM::InstrSetUtil{
 		}
 		template<typename U>
 		static bool is_instr(raw_t instr){
-			return get_id<U>()==to_instr<U>(instr).id;
+			constexpr size_t id=get_id<U>();//force compile time, get_id sorts the reserved ids
+			return id==to_instr<U>(instr).id;
 		}
 		template<typename V,typename ...U>
 		static instr_ts get_instr_impl(raw_t instr){
@@ -112,12 +141,39 @@ namespace SOASM::InstrSetUtil{
 				return to_instr<Unknown>(instr);
 			}
 		}
+		//variant index of every opcode, ids sit above the opts as in pack(), only built for 8 bit raws
+		static constexpr auto index_table=[]{
+			std::array<uint8_t,raw::size==1?256:0> table{};
+			constexpr std::array<size_t,sizeof...(T)> ids{get_id<T>()...};
+			for(size_t op=0;op<table.size();++op){
+				size_t index=0,i=0;
+				((index=(index==0 && (op>>T::optw)==ids[i])?i+1:index,++i),...);
+				table[op]=index;
+			}
+			return table;
+		}();
 		static instr_ts get_instr(raw_t data){
-			return get_instr_impl<T...>(data);
+			SOASM_METRIC_INC(Metrics::decode);
+			SOASM_METRIC_TIME_SAMPLED(Metrics::decode_ns,Metrics::sample_period);
+			if constexpr(raw::size==1){
+				static constexpr std::array<instr_ts(*)(raw_t),sizeof...(T)+1> make{
+					[](raw_t raw)->instr_ts{return to_instr<Unknown>(raw);},
+					[](raw_t raw)->instr_ts{return to_instr<T>(raw);}...
+				};
+				return make[index_table[data]](data);
+			}else{
+				return get_instr_impl<T...>(data);
+			}
 		}
 		static instr_ts get_instr(std::span<uint8_t> data){
 			return get_instr(raw::from_bytes(data));
 		}
+		//instruction and its args, data must hold the largest instruction
+		static record_ts get_record(std::span<uint8_t> data){
+			return std::visit([&]<typename U>(U instr)->record_ts{
+				return typename U::Record{instr,U::args_t::from_bytes(data.subspan(raw::size))};
+			},get_instr(data));
+		}
 		static auto list_instr(){
 			return std::vector{
 				std::tuple{T::name,get_id<T>(),T::optw}...
@@ -0,0 +1,104 @@
+#ifndef SOASM_INTERPRETER_HPP
+#define SOASM_INTERPRETER_HPP
+
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <tuple>
+#include <variant>
+#include <utility>
+#include "instr_set_util.hpp"
+#include "metrics.hpp"
+
+namespace SOASM{
+	//Table driven dispatch for any InstrSet.
+	//handlers[opcode] executes one instruction: reads its args from Memory, moves pc past them and calls
+	//State::run_instr(instr,args...), which moves pc past the opcode or jumps.
+	//For 8 bit raws the table is built at compile time with one handler per opcode, so the opts of every
+	//instruction are constants in its handler. Wider raws share one handler per instruction and decode
+	//the opts at run time, their table is built at static initialization.
+	//State needs pc, and if it has cycles and a static constexpr cost<T>, cost<T> is added to cycles.
+	template<typename InstrSet,typename State,typename Memory>
+	struct Interpreter{
+		using raw=InstrSet::raw;
+		using raw_t=raw::type;
+		using instr_ts=InstrSet::instr_ts;
+		//returns size of the executed instruction
+		using handler_t=size_t(*)(State&,Memory&,raw_t);
+
+		//instruction of opcode, usable in constant expressions unlike bit_cast of the bitfields
+		template<typename T>
+		static constexpr T decode(raw_t op){
+			using opts_t=T::opts_t;
+			T instr{};
+			[&]<size_t ...I>(std::index_sequence<I...>){
+				size_t shift=0;
+				((instr.set_opt(I,(uintmax_t{op}>>shift)&InstrSetUtil::opt_mask<std::tuple_element_t<I,opts_t>>()),
+				  shift+=InstrSetUtil::opt_width<std::tuple_element_t<I,opts_t>>()),...);
+			}(std::make_index_sequence<std::tuple_size_v<opts_t>-1>{});
+			instr.id=op>>T::optw;
+			return instr;
+		}
+
+		template<typename T>
+		static size_t execute(State& state,Memory& mem,T instr){
+			if constexpr(requires{State::template cost<T>;}){
+				state.cycles+=State::template cost<T>;
+			}
+			if constexpr(0==T::args_t::num){
+				state.run_instr(instr);
+			}else{
+				auto arg_bytes=mem.template get_bytes<T::args_t::size>(state.pc+raw::size);
+				auto arg_raws=T::args_t::from_bytes(arg_bytes);
+				state.pc+=T::args_t::size;
+				std::apply([&](auto... args){state.run_instr(instr,args...);},arg_raws);
+			}
+			return T::size;
+		}
+		template<typename T,raw_t op>
+		static size_t handle_const(State& state,Memory& mem,raw_t){
+			static constexpr T instr=decode<T>(op);
+			return execute(state,mem,instr);
+		}
+		template<typename T>
+		static size_t handle(State& state,Memory& mem,raw_t op){
+			return execute(state,mem,std::bit_cast<T>(op));
+		}
+
+		static constexpr auto by_index=[]<typename ...T>(std::type_identity<std::variant<T...>>){
+			return std::array<handler_t,sizeof...(T)>{&handle<T>...};
+		}(std::type_identity<instr_ts>{});
+		static constexpr auto build(){
+			if constexpr(raw::size==1){
+				return []<size_t ...Op>(std::index_sequence<Op...>){
+					return std::array<handler_t,sizeof...(Op)>{
+						&handle_const<std::variant_alternative_t<InstrSet::index_table[Op],instr_ts>,Op>...
+					};
+				}(std::make_index_sequence<256>{});
+			}else{
+				std::vector<handler_t> table(1uz<<(raw::size*CHAR_BIT));
+				for(size_t op=0;op<table.size();++op){
+					table[op]=by_index[InstrSet::get_instr(static_cast<raw_t>(op)).index()];
+				}
+				return table;
+			}
+		}
+		static inline const auto handlers=build();//constant initialized for 8 bit raws
+
+		//execute instruction at pc, return its size
+		static size_t step(State& state,Memory& mem){
+			SOASM_METRIC_INC(Metrics::decode);
+			raw_t op;
+			handler_t handler;
+			{//decode only, the handler is timed by the dispatch metrics of the caller
+				SOASM_METRIC_TIME_SAMPLED(Metrics::decode_ns,Metrics::sample_period);
+				auto op_bytes=mem.template get_bytes<raw::size>(state.pc);
+				op=static_cast<raw_t>(raw::from_bytes(op_bytes));
+				handler=handlers[op];
+			}
+			return handler(state,mem,op);
+		}
+	};
+} // SOASM
+
+#endif //SOASM_INTERPRETER_HPP
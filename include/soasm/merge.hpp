@@ -0,0 +1,66 @@
+#ifndef SOASM_MERGE_HPP
+#define SOASM_MERGE_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <stdexcept>
+#include "asm.hpp"
+#include "cfg.hpp"
+
+//Merge stage run on finished blocks before they are laid out.
+//Blocks are compared in a canonical form where references to labels defined in the block are numbered by the order
+//the labels are defined, so identical blocks at different addresses compare equal. One copy of every group of identical
+//blocks is kept and the labels of the others become aliases of the corresponding labels of the copy.
+//Data blocks of plain bytes that are a suffix of another one are placed at the end of it.
+//Blocks with fixed labels or custom lazy values are kept as they are.
+//Removing a code block changes what the blocks around it fall into, so a code block is only folded if the caller
+//reports that it and the block laid out before it end in an unconditional transfer (Jump, Return, Halt).
+//Without that report code blocks are never folded. The end label of a folded block is the end of the kept copy.
+namespace SOASM{
+	struct MergeReport{
+		size_t code_folded=0;//code blocks removed as duplicates
+		size_t data_folded=0;
+		size_t data_suffixes=0;//data blocks placed inside a longer one
+		size_t bytes_saved=0;
+	};
+	struct Merged{
+		Code code{};//kept blocks, code blocks first, in their original order
+		std::vector<std::pair<Label,Label>> aliases{};//label of a removed block, label it is placed at
+		MergeReport report{};
+
+		//resolve code, then give every alias the address of its label
+		[[nodiscard]] data_t resolve(size_t start=0,uint8_t padding=0xff) const;
+		[[nodiscard]] bytes_t assemble(size_t start=0,uint8_t padding=0xff) const{
+			return Code::assemble(resolve(start,padding));
+		}
+	};
+	//true if a code block ends in an unconditional transfer
+	using Terminated=std::function<bool(const CodeBlock&)>;
+	Merged merge(std::span<const CodeBlock> code,std::span<const DataBlock> data={},const Terminated& terminated={});
+
+	//Terminated for blocks of InstrSet, the flow of the last instruction is found by ADL as for CFG.
+	//Blocks that are empty or are not only instructions and labels are reported as falling through.
+	template<typename InstrSet>
+	bool ends_in_transfer(const CodeBlock& block){
+		using Instr=Decoded<InstrSet>::Instr;
+		Decoded<InstrSet> decoded;
+		try{
+			decoded=Decoded<InstrSet>::decode(block.body);
+		}catch(const std::invalid_argument&){
+			return false;
+		}
+		for (const auto &item:decoded.items|std::views::reverse) {
+			if(auto instr=std::get_if<Instr>(&item)){
+				return std::visit([]<typename T>(const T& last){
+					return !flow(last,typename T::args_t::raws_t{}).falls_through();
+				},instr->instr);
+			}
+		}
+		return false;
+	}
+} // SOASM
+
+#endif //SOASM_MERGE_HPP
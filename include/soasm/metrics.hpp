@@ -0,0 +1,23 @@
+#ifndef SOASM_METRICS_HPP
+#define SOASM_METRICS_HPP
+
+#include "util/metrics.hpp"
+
+//Host side metrics of the assembler and emulators, enabled with the SOASM_ENABLE_METRICS CMake option.
+//Timings are in nanoseconds, per instruction timings are sampled.
+namespace SOASM::Metrics{
+	inline constexpr uint32_t sample_period=1024;
+
+	SOASM_METRIC_COUNTER(decode,"soasm_decode_total","opcodes decoded by Interpreter::step and InstrSet::get_instr");
+	SOASM_METRIC_HISTOGRAM(decode_ns,"soasm_decode_ns","sampled time of fetching and decoding an opcode in Interpreter::step or InstrSet::get_instr");
+	SOASM_METRIC_COUNTER(dispatch,"soasm_dispatch_total","instructions executed by Context::run");
+	SOASM_METRIC_HISTOGRAM(dispatch_ns,"soasm_dispatch_ns","sampled time of Context::run");
+	SOASM_METRIC_COUNTER(mem_read,"soasm_mem_read_total","bytes read through Memory::get");
+	SOASM_METRIC_COUNTER(mem_write,"soasm_mem_write_total","bytes written through Memory::set");
+	SOASM_METRIC_HISTOGRAM(mem_overlay_size,"soasm_mem_overlay_size","overlay entries when one is added");
+	SOASM_METRIC_HISTOGRAM(resolve_ns,"soasm_resolve_ns","time of Code::resolve");
+	SOASM_METRIC_HISTOGRAM(assemble_ns,"soasm_assemble_ns","time of Code::assemble");
+	SOASM_METRIC_COUNTER(lazy_eval,"soasm_lazy_eval_total","lazy values evaluated by Code::assemble");
+} // SOASM::Metrics
+
+#endif //SOASM_METRICS_HPP
@@ -0,0 +1,245 @@
+#ifndef SOASM_EXECUTOR_HPP
+#define SOASM_EXECUTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include "scheduler.hpp"
+
+namespace SOASM::Models{
+	struct Executor;
+
+	//Coroutine driving one machine, started and resumed by an Executor.
+	//The frame is freed when the coroutine finishes, so a live machine costs its Context and one frame.
+	struct Task{
+		struct promise_type{
+			Executor* executor=nullptr;
+			Task get_return_object(){
+				return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+			}
+			std::suspend_always initial_suspend() noexcept{
+				return {};
+			}
+			auto final_suspend() noexcept;
+			void return_void(){}
+			void unhandled_exception(){
+				std::terminate();
+			}
+		};
+		std::coroutine_handle<promise_type> handle;
+
+		explicit Task(std::coroutine_handle<promise_type> handle):handle(handle){}
+		Task(Task&& other) noexcept:handle(std::exchange(other.handle,nullptr)){}
+		Task& operator=(Task&&)=delete;
+		~Task(){
+			if(handle){
+				handle.destroy();
+			}
+		}
+	};
+
+	//Small work-stealing executor for coroutines.
+	//Every worker thread owns a queue, it resumes its own coroutines in FIFO order, so every ready machine
+	//gets its turn, and steals from the back of the other queues when its own is empty.
+	//Coroutines suspended by a worker are queued to that worker again, which keeps machines on one thread.
+	struct Executor{
+		explicit Executor(size_t threads=std::thread::hardware_concurrency())
+			:queues(std::max<size_t>(threads,1)){
+			for(size_t id=0;id<queues.size();++id){
+				workers.emplace_back([this,id]{work(id);});
+			}
+		}
+		Executor(const Executor&)=delete;
+		~Executor(){
+			wait();
+			{
+				std::lock_guard lock{idle_mutex};
+				stopping=true;
+			}
+			idle.notify_all();
+		}
+
+		void spawn(Task task){
+			auto handle=std::exchange(task.handle,nullptr);
+			handle.promise().executor=this;
+			live.fetch_add(1,std::memory_order_relaxed);
+			schedule(handle);
+		}
+		void schedule(std::coroutine_handle<> handle){
+			auto id=current==this?current_id:next_queue.fetch_add(1,std::memory_order_relaxed)%queues.size();
+			{
+				std::lock_guard lock{queues[id].mutex};
+				queues[id].ready.push_back(handle);
+				queued.fetch_add(1);//under the queue lock, so a worker taking the handle decrements after
+			}
+			//a worker counts itself sleeping before it checks queued, so one of both sees the other
+			if(sleeping.load()>0){
+				std::lock_guard lock{idle_mutex};
+				idle.notify_one();
+			}
+		}
+		//block until every spawned task finished
+		void wait(){
+			for(auto n=live.load();n!=0;n=live.load()){
+				live.wait(n);
+			}
+		}
+		[[nodiscard]] size_t running() const{
+			return live.load(std::memory_order_relaxed);
+		}
+		//executor of the calling worker thread
+		static Executor* this_executor(){
+			return current;
+		}
+		//let other ready coroutines run first
+		static auto yield(){
+			struct Awaiter{
+				bool await_ready() const noexcept{
+					return current==nullptr;
+				}
+				void await_suspend(std::coroutine_handle<> handle) const{
+					current->schedule(handle);
+				}
+				void await_resume() const noexcept{}
+			};
+			return Awaiter{};
+		}
+
+	private:
+		friend Task::promise_type;
+		struct Queue{
+			std::mutex mutex;
+			std::deque<std::coroutine_handle<>> ready;
+		};
+		std::vector<Queue> queues;
+		std::atomic<size_t> next_queue{0};
+		std::atomic<size_t> live{0};
+		std::atomic<size_t> queued{0};//handles in the queues
+		std::atomic<size_t> sleeping{0};//workers waiting for idle
+		std::mutex idle_mutex;
+		std::condition_variable idle;
+		bool stopping=false;//guarded by idle_mutex
+		std::vector<std::jthread> workers{};//last member, joined before the queues are destroyed
+		static inline thread_local Executor* current=nullptr;
+		static inline thread_local size_t current_id=0;
+
+		void finished(){
+			if(live.fetch_sub(1,std::memory_order_acq_rel)==1){
+				live.notify_all();
+			}
+		}
+		std::coroutine_handle<> take(size_t id){
+			for(size_t i=0;i<queues.size();++i){
+				auto& queue=queues[(id+i)%queues.size()];
+				std::lock_guard lock{queue.mutex};
+				if(!queue.ready.empty()){
+					std::coroutine_handle<> handle;
+					if(i==0){
+						handle=queue.ready.front();
+						queue.ready.pop_front();
+					}else{
+						handle=queue.ready.back();
+						queue.ready.pop_back();
+					}
+					return handle;
+				}
+			}
+			return nullptr;
+		}
+		void work(size_t id){
+			current=this;
+			current_id=id;
+			while(true){
+				if(auto handle=take(id)){
+					queued.fetch_sub(1,std::memory_order_relaxed);
+					handle.resume();
+					continue;
+				}
+				std::unique_lock lock{idle_mutex};
+				if(stopping){
+					return;
+				}
+				sleeping.fetch_add(1);
+				idle.wait(lock,[&]{return stopping || queued.load()>0;});
+				sleeping.fetch_sub(1);
+			}
+		}
+	};
+
+	inline auto Task::promise_type::final_suspend() noexcept{
+		struct Final{
+			bool await_ready() const noexcept{
+				return false;
+			}
+			void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept{
+				auto executor=handle.promise().executor;
+				handle.destroy();
+				if(executor){
+					executor->finished();
+				}
+			}
+			void await_resume() const noexcept{}
+		};
+		return Final{};
+	}
+
+	enum struct Stop{
+		Budget,//ran budget steps
+		IO,//the last instruction accessed an io range of the memory
+		Halted,
+	};
+	struct RunResult{
+		Stop stop;
+		uint64_t steps;
+	};
+	template<typename Core>
+	concept IOCore=TimedCore<Core> && requires(Core core){
+		{core.mem.io_access}->std::convertible_to<bool>;
+	};
+	//Awaitable running a core for at most budget steps, see run_for.
+	//The steps run in await_ready, then the coroutine is queued behind the other ready ones, unless the core halted.
+	template<IOCore Core>
+	struct RunFor{
+		Core& core;
+		uint64_t budget;
+		RunResult result{Stop::Budget,0};
+
+		bool await_ready(){
+			core.mem.io_access=false;
+			for(auto& [stop,steps]=result;steps<budget;){
+				++steps;
+				if(!core.run()){
+					stop=Stop::Halted;
+					return true;
+				}
+				if(core.mem.io_access){
+					stop=Stop::IO;
+					break;
+				}
+			}
+			return Executor::this_executor()==nullptr;
+		}
+		void await_suspend(std::coroutine_handle<> handle) const{
+			Executor::this_executor()->schedule(handle);
+		}
+		RunResult await_resume() const noexcept{
+			return result;
+		}
+	};
+	//co_await run_for(core,budget) inside a Task
+	template<IOCore Core>
+	RunFor<Core> run_for(Core& core,uint64_t budget){
+		return {core,budget};
+	}
+} // SOASM::Models
+
+#endif //SOASM_EXECUTOR_HPP
@@ -1,19 +1,116 @@
-
 #ifndef SOASM_MEMORY_HPP
 #define SOASM_MEMORY_HPP
 
 #include <cstddef>
 #include <memory>
 #include <map>
+#include <array>
+#include <span>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include "../util/accessors_proxy.hpp"
+#include "../metrics.hpp"
 
 namespace SOASM::Models{
 	template<size_t Size>
 	struct Memory:Util::AccessorsProxy<Memory<Size>>{
+		struct Region{//address range backed by storage shared with other memories, accessed atomically
+			size_t begin;
+			std::span<uint8_t> data;
+			bool contains(size_t addr) const{
+				return addr-begin<data.size();
+			}
+		};
 		const std::array<uint8_t,Size>& base;
 		std::map<size_t,uint8_t> overlay{};
+		std::vector<Region> shared{};
+		//accesses to pages with the watch bit set are passed to on_watch, instruction fetch is not watched
+		static constexpr size_t page_bits=8;
+		std::vector<bool> watched{};
+		std::function<void(size_t addr,uint8_t v,bool write)> on_watch{};
+		//accesses to io ranges [begin,end) set io_access, so whoever runs the core can stop and serve them
+		std::vector<std::pair<size_t,size_t>> io{};
+		mutable bool io_access=false;
+		//pages whose bytes are not in the overlay yet, restore puts them there on first access, see SOISv1::resume
+		//restoring does not change what the memory holds, so const accesses restore too
+		mutable std::vector<bool> pending{};
+		mutable size_t pending_pages=0;
+		//dropped after the last page is restored, so what it holds is released
+		mutable std::function<void(std::map<size_t,uint8_t>& overlay,size_t page)> restore{};
 		Memory(const std::array<uint8_t,Size>& mem):base{mem}{}
+		void share(size_t begin,std::span<uint8_t> data){
+			shared.emplace_back(begin,data);
+		}
+		uint8_t* find_shared(size_t addr) const{
+			for(auto& region:shared){
+				if(region.contains(addr)){
+					return &region.data[addr-region.begin];
+				}
+			}
+			return nullptr;
+		}
+		//watch the pages holding [begin,end)
+		void watch_pages(size_t begin,size_t end){
+			watched.resize(Size>>page_bits);
+			if(begin>=end){
+				return;
+			}
+			for(auto page=begin>>page_bits;page<=((end-1)>>page_bits) && page<watched.size();++page){
+				watched[page]=true;
+			}
+		}
+		void map_io(size_t begin,size_t end){
+			io.emplace_back(begin,end);
+		}
+		void check_io(size_t addr) const{
+			for(auto [begin,end]:io){
+				if(addr-begin<end-begin){
+					io_access=true;
+				}
+			}
+		}
+		void restore_page(size_t page) const{
+			pending[page]=false;
+			auto& target=const_cast<std::map<size_t,uint8_t>&>(overlay);
+			if(--pending_pages==0){
+				pending.clear();
+				std::exchange(restore,{})(target,page);
+				return;
+			}
+			restore(target,page);
+		}
+		void restore_all(){
+			for(size_t page=0;page<pending.size();++page){
+				if(pending[page]){
+					restore_page(page);
+				}
+			}
+		}
+		bool is_watched(size_t addr) const{
+			return !watched.empty() && watched[addr>>page_bits] && on_watch;
+		}
 		uint8_t get(size_t addr) const{
+			SOASM_METRIC_INC(SOASM::Metrics::mem_read);
+			auto v=peek(addr);
+			if(is_watched(addr))[[unlikely]]{
+				on_watch(addr,v,false);
+			}
+			if(!io.empty())[[unlikely]]{
+				check_io(addr);
+			}
+			return v;
+		}
+		uint8_t peek(size_t addr) const{
+			if(!pending.empty() && pending[addr>>page_bits])[[unlikely]]{
+				restore_page(addr>>page_bits);
+			}
+			if(auto p=find_shared(addr)){
+				return std::atomic_ref<uint8_t>(*p).load(std::memory_order_relaxed);
+			}
 			auto it=overlay.find(addr);
 			if(it==overlay.end()){
 				return base[addr];
@@ -21,16 +118,115 @@ namespace SOASM::Models{
 			return it->second;
 		}
 		void set(size_t addr,uint8_t v){
-			overlay[addr]=v;
+			SOASM_METRIC_INC(SOASM::Metrics::mem_write);
+			if(is_watched(addr))[[unlikely]]{
+				on_watch(addr,v,true);
+			}
+			if(!io.empty())[[unlikely]]{
+				check_io(addr);
+			}
+			if(!pending.empty() && pending[addr>>page_bits])[[unlikely]]{
+				restore_page(addr>>page_bits);
+			}
+			if(auto p=find_shared(addr)){
+				std::atomic_ref<uint8_t>(*p).store(v,std::memory_order_relaxed);
+				return;
+			}
+			if(overlay.insert_or_assign(addr,v).second){
+				SOASM_METRIC_OBSERVE(SOASM::Metrics::mem_overlay_size,overlay.size());
+			}
+		}
+		//bulk access, same result as accessing the bytes one by one with addresses wrapping at Size
+		void read(size_t addr,std::span<uint8_t> out) const{
+			if(!plain()){
+				for(auto& d:out){
+					d=get(addr++%Size);
+				}
+				return;
+			}
+			SOASM_METRIC_ADD(SOASM::Metrics::mem_read,out.size());
+			for_segments(addr,out.size(),[&](size_t begin,size_t n,size_t done){
+				std::memcpy(out.data()+done,base.data()+begin,n);
+				for(auto it=overlay.lower_bound(begin);it!=overlay.end() && it->first<begin+n;++it){
+					out[done+it->first-begin]=it->second;
+				}
+			});
+		}
+		void write(size_t addr,std::span<const uint8_t> in){
+			if(!plain()){
+				for(auto d:in){
+					set(addr++%Size,d);
+				}
+				return;
+			}
+			SOASM_METRIC_ADD(SOASM::Metrics::mem_write,in.size());
+			for_segments(addr,in.size(),[&](size_t begin,size_t n,size_t done){
+				auto hint=overlay.lower_bound(begin);
+				for(size_t i=0;i<n;++i){
+					hint=std::next(overlay.insert_or_assign(hint,begin+i,in[done+i]));
+				}
+			});
+			SOASM_METRIC_OBSERVE(SOASM::Metrics::mem_overlay_size,overlay.size());
 		}
+		//bulk instructions, chunks go through a stack buffer so they never allocate
+		static constexpr size_t bulk_chunk=256;
+		//like memmove, the last chunk goes first if to starts inside [from,from+size)
+		void copy(size_t to,size_t from,size_t size){
+			bool backward=(to-from)%Size!=0 && (to-from)%Size<size;
+			std::array<uint8_t,bulk_chunk> buf;
+			for(size_t done=0;done<size;){
+				auto n=std::min(bulk_chunk,size-done);
+				auto offset=backward?size-done-n:done;
+				read((from+offset)%Size,std::span(buf).first(n));
+				write((to+offset)%Size,std::span<const uint8_t>(buf).first(n));
+				done+=n;
+			}
+		}
+		//stops at the first chunk that differs
+		bool compare(size_t lhs,size_t rhs,size_t size) const{
+			std::array<uint8_t,bulk_chunk> lhs_buf,rhs_buf;
+			for(size_t done=0;done<size;){
+				auto n=std::min(bulk_chunk,size-done);
+				read((lhs+done)%Size,std::span(lhs_buf).first(n));
+				read((rhs+done)%Size,std::span(rhs_buf).first(n));
+				if(std::memcmp(lhs_buf.data(),rhs_buf.data(),n)!=0){
+					return false;
+				}
+				done+=n;
+			}
+			return true;
+		}
+		void fill(size_t to,size_t size,uint8_t v){
+			std::array<uint8_t,bulk_chunk> buf;
+			buf.fill(v);
+			for(size_t done=0;done<size;){
+				auto n=std::min(bulk_chunk,size-done);
+				write((to+done)%Size,std::span<const uint8_t>(buf).first(n));
+				done+=n;
+			}
+		}
+		//addresses wrap at Size like bulk reads, so an instruction at the top of memory takes its args from the bottom
 		template<size_t size>
 		std::array<uint8_t,size> get_bytes(size_t addr) const{
 			std::array<uint8_t,size> data;
 			for(auto&& d:data){
-				d=get(addr++);
+				d=peek(addr++%Size);
 			}
 			return data;
 		}
+	private:
+		//no shared region, watch, io range or pending page to honour, bulk access may go to base and overlay directly
+		bool plain() const{
+			return shared.empty() && io.empty() && pending.empty() && (watched.empty() || !on_watch);
+		}
+		static void for_segments(size_t addr,size_t size,auto&& fn){
+			for(size_t done=0;done<size;){
+				auto begin=(addr+done)%Size;
+				auto n=std::min(size-done,Size-begin);
+				fn(begin,n,done);
+				done+=n;
+			}
+		}
 	};
 } // SOASM
 
@@ -0,0 +1,77 @@
+#ifndef SOASM_PARALLEL_SCHEDULER_HPP
+#define SOASM_PARALLEL_SCHEDULER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <barrier>
+#include <thread>
+#include <algorithm>
+#include "scheduler.hpp"
+
+namespace SOASM::Models{
+	//Runs cores on host threads in parallel, cores are statically distributed over the threads.
+	//Private memory stays in each core's overlay, shared regions are accessed atomically and
+	//all threads meet at a barrier after every quantum, so cores never drift more than one quantum apart.
+	//A barrier costs far more than a step, so the default quantum keeps it small next to the work,
+	//a smaller quantum only pays off if cores must keep closer in time.
+	template<TimedCore Core>
+	struct ParallelScheduler{
+		struct Slot{
+			Core* core;
+			bool halted=false;
+		};
+
+		uint64_t quantum;
+		size_t threads;
+		std::vector<Slot> slots{};
+
+		static constexpr uint64_t default_quantum=1u<<16;
+
+		explicit ParallelScheduler(uint64_t quantum=default_quantum,size_t threads=std::thread::hardware_concurrency())
+			:quantum(quantum),threads(std::max<size_t>(threads,1)){}
+		size_t add(Core& core){
+			slots.emplace_back(&core);
+			return slots.size()-1;
+		}
+		//run until all cores halted or max_rounds passed, return rounds run, no round is run if max_rounds is 0
+		size_t run(size_t max_rounds=SIZE_MAX){
+			auto n=std::min(threads,slots.size());
+			if(n==0 || max_rounds==0){
+				return 0;
+			}
+			std::atomic<size_t> running{0};
+			size_t rounds=0;
+			bool stop=false;
+			std::barrier sync{static_cast<ptrdiff_t>(n),[&]()noexcept{
+				++rounds;
+				stop=running.exchange(0,std::memory_order_relaxed)==0 || rounds>=max_rounds;
+			}};
+			auto worker=[&](size_t id){
+				for(uint64_t deadline=quantum;!stop;deadline+=quantum){
+					size_t alive=0;
+					for(size_t i=id;i<slots.size();i+=n){
+						auto& [core,halted]=slots[i];
+						while(!halted && core->cycles<deadline){
+							halted=!core->run();
+						}
+						alive+=halted?0:1;
+					}
+					running.fetch_add(alive,std::memory_order_relaxed);
+					sync.arrive_and_wait();
+				}
+			};
+			{
+				std::vector<std::jthread> pool;
+				for(size_t id=1;id<n;++id){
+					pool.emplace_back(worker,id);
+				}
+				worker(0);
+			}
+			return rounds;
+		}
+	};
+} // SOASM::Models
+
+#endif //SOASM_PARALLEL_SCHEDULER_HPP
@@ -0,0 +1,72 @@
+#ifndef SOASM_SCHEDULER_HPP
+#define SOASM_SCHEDULER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+namespace SOASM::Models{
+	template<typename Core>
+	concept TimedCore=requires(Core core){
+		{core.run()}->std::convertible_to<bool>;
+		{core.cycles}->std::convertible_to<uint64_t>;
+	};
+
+	//Deterministic round-robin scheduler for cores sharing memory regions.
+	//Each round every running core, in the order they were added, runs until its cycle count reaches
+	//the end of the round, so the interleaving only depends on the programs and the quantum.
+	//Large quanta give throughput, small quanta give accuracy.
+	template<TimedCore Core>
+	struct Scheduler{
+		struct Slot{
+			Core* core;
+			bool halted=false;
+		};
+		using trace_t=std::function<void(size_t core,uint64_t from,uint64_t to)>;
+
+		uint64_t quantum;
+		uint64_t now=0;
+		std::vector<Slot> slots{};
+		trace_t trace{};
+
+		explicit Scheduler(uint64_t quantum=1):quantum(quantum){}
+		size_t add(Core& core){
+			slots.emplace_back(&core);
+			return slots.size()-1;
+		}
+		[[nodiscard]] bool running() const{
+			return std::ranges::any_of(slots,[](const Slot& slot){return !slot.halted;});
+		}
+		//run one quantum on every core, return false if all cores halted
+		bool round(){
+			auto deadline=now+quantum;
+			for(size_t i=0;i<slots.size();++i){
+				auto& [core,halted]=slots[i];
+				auto from=core->cycles;
+				while(!halted && core->cycles<deadline){
+					halted=!core->run();
+				}
+				if(trace){
+					trace(i,from,core->cycles);
+				}
+			}
+			now=deadline;
+			return running();
+		}
+		//run until all cores halted or max_rounds passed, return rounds run
+		size_t run(size_t max_rounds=SIZE_MAX){
+			size_t rounds=0;
+			while(rounds<max_rounds){
+				++rounds;
+				if(!round()){
+					break;
+				}
+			}
+			return rounds;
+		}
+	};
+} // SOASM::Models
+
+#endif //SOASM_SCHEDULER_HPP
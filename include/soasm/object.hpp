@@ -0,0 +1,121 @@
+#ifndef SOASM_OBJECT_HPP
+#define SOASM_OBJECT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <bit>
+#include "asm.hpp"
+
+//Relocatable object file.
+//All tables are arrays of fixed size little-endian records aligned to 4 bytes, so a mapped file is used in place.
+//	Header | Section[] | Symbol[] | Reloc[] | string table | section data
+namespace SOASM::Object{
+	static_assert(std::endian::native==std::endian::little,"object files are read in place");
+
+	inline constexpr uint32_t magic=0x4a424f53;//"SOBJ"
+	inline constexpr uint16_t version=1;
+	inline constexpr uint32_t none=0xffffffff;
+
+	struct Header{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t flags;
+		uint32_t section_count;
+		uint32_t symbol_count;
+		uint32_t reloc_count;
+		uint32_t strtab_size;
+		uint32_t section_off;
+		uint32_t symbol_off;
+		uint32_t reloc_off;
+		uint32_t strtab_off;
+	};
+	struct Section{
+		uint32_t name;//offset in string table
+		uint32_t data_off;//offset in file
+		uint32_t size;
+		uint32_t addr;//fixed address, or none if the linker may place it anywhere
+	};
+	struct Symbol{
+		enum:uint32_t{
+			External=none,//defined in other object
+			Absolute=none-1,//value is an address
+		};
+		uint32_t name;//offset in string table, empty name is local to this object
+		uint32_t section;//index of section, External or Absolute
+		uint32_t value;//offset in section
+	};
+	struct Reloc{
+		uint32_t section;
+		uint32_t offset;//of the patched byte in section
+		uint32_t symbol;
+		Lazy::Kind kind;//Absolute or Relative
+		uint8_t shift;//patched byte is (value>>shift)&0xff
+		uint16_t reserved;
+	};
+
+	struct View{
+		std::span<const uint8_t> file;
+
+		//header, tables, and every offset, index and name in them lie inside the file, the other accessors rely on it
+		[[nodiscard]] bool valid() const;
+		[[nodiscard]] const Header& header() const{
+			return *reinterpret_cast<const Header*>(file.data());
+		}
+		[[nodiscard]] std::span<const Section> sections() const{
+			return table<Section>(header().section_off,header().section_count);
+		}
+		[[nodiscard]] std::span<const Symbol> symbols() const{
+			return table<Symbol>(header().symbol_off,header().symbol_count);
+		}
+		[[nodiscard]] std::span<const Reloc> relocs() const{
+			return table<Reloc>(header().reloc_off,header().reloc_count);
+		}
+		[[nodiscard]] std::string_view name(uint32_t offset) const{
+			return {reinterpret_cast<const char*>(file.data()+header().strtab_off+offset)};
+		}
+		[[nodiscard]] std::span<const uint8_t> data(const Section& section) const{
+			return file.subspan(section.data_off,section.size);
+		}
+	private:
+		template<typename T>
+		std::span<const T> table(uint32_t offset,uint32_t count) const{
+			return {reinterpret_cast<const T*>(file.data()+offset),count};
+		}
+	};
+
+	//Collect blocks into one object. Labels defined in the blocks become symbols,
+	//other labels are referenced by the name they have in the label table.
+	struct Writer{
+		const Label::tbl_t& names;
+		std::vector<std::pair<std::string,Code>> sections{};
+
+		explicit Writer(const Label::tbl_t& names=Label::tbl):names(names){}
+		Writer& add(std::string name,Code code){
+			sections.emplace_back(std::move(name),std::move(code));
+			return *this;
+		}
+		Writer& add(const CodeBlock& block){
+			return add(name_of(block.start),block.to_code());
+		}
+		Writer& add(const DataBlock& block){
+			return add(name_of(block.start),block.to_code());
+		}
+		[[nodiscard]] std::string name_of(const Label& label) const;
+		[[nodiscard]] bytes_t write() const;
+	};
+
+	//Place sections of all objects in order starting from start, and patch relocations in one pass.
+	struct Linker{
+		size_t start=0;
+		size_t size=1uz<<16;
+		uint8_t padding=0xff;
+
+		[[nodiscard]] bytes_t link(std::span<const View> objects) const;
+	};
+} // SOASM::Object
+
+#endif //SOASM_OBJECT_HPP
@@ -0,0 +1,174 @@
+#ifndef SOASM_PARSER_HPP
+#define SOASM_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <charconv>
+#include <cctype>
+#include <tuple>
+#include <algorithm>
+#include <variant>
+#include "instr.hpp"
+#include "instr_set_util.hpp"
+
+//Text assembler for the syntax printed by disassemble, one statement per line:
+//	name:                     define label
+//	Name opts... args...      instruction, args may be wrapped as (a, b) and may be numbers or label names
+//	; comment
+namespace SOASM{
+	struct ParseError:std::runtime_error{
+		size_t line;
+		ParseError(size_t line,const std::string& msg):std::runtime_error("line "+std::to_string(line)+": "+msg),line(line){}
+	};
+
+	template<typename InstrSet>
+	struct Parser{
+		struct Lexer{
+			std::string_view rest;
+			static constexpr bool is_sep(char c){
+				return c==' '||c=='\t'||c=='\r'||c==','||c=='('||c==')';
+			}
+			std::string_view next(){
+				size_t b=0;
+				while(b<rest.size() && is_sep(rest[b])){++b;}
+				size_t e=b;
+				while(e<rest.size() && !is_sep(rest[e])){++e;}
+				auto token=rest.substr(b,e-b);
+				rest.remove_prefix(e);
+				return token;
+			}
+		};
+		using handler_t=void(*)(Parser&,Lexer&,Code&);
+		struct Entry{
+			std::string_view name;
+			handler_t handler;
+		};
+
+		Label::tbl_t& labels;
+		size_t line=0;
+
+		explicit Parser(Label::tbl_t& labels=Label::tbl):labels(labels){}
+
+		Code parse(std::string_view source){
+			Code code;
+			parse(source,code);
+			return code;
+		}
+		void parse(std::string_view source,Code& out){
+			while(!source.empty()){
+				auto eol=source.find('\n');
+				parse_line(source.substr(0,eol),out);
+				source.remove_prefix(eol==std::string_view::npos?source.size():eol+1);
+			}
+		}
+		void parse_line(std::string_view text,Code& out){
+			++line;
+			Lexer lex{text.substr(0,text.find(';'))};
+			auto head=lex.next();
+			if(head.empty()){
+				return;
+			}
+			if(head.back()==':'){
+				out.add(label(head.substr(0,head.size()-1)));
+			}else if(auto handler=find(head)){
+				handler(*this,lex,out);
+			}else{
+				error("unknown instruction",head);
+			}
+			if(auto extra=lex.next();!extra.empty()){
+				error("unexpected token",extra);
+			}
+		}
+
+		static handler_t find(std::string_view name){
+			static constexpr auto table=[]<typename U,typename ...T>(std::type_identity<std::variant<U,T...>>){
+				std::array<Entry,sizeof...(T)> entries{Entry{T::name,&Parser::handle<T>}...};
+				std::ranges::sort(entries,{},&Entry::name);
+				return entries;
+			}(std::type_identity<typename InstrSet::instr_ts>{});
+			auto it=std::ranges::lower_bound(table,name,{},&Entry::name);
+			return it!=table.end() && it->name==name?it->handler:nullptr;
+		}
+
+	private:
+		[[noreturn]] void error(std::string_view msg,std::string_view token) const{
+			throw ParseError(line,std::string(msg)+" '"+std::string(token)+"'");
+		}
+		Label label(std::string_view name){
+			if(name.empty()){
+				error("empty label name",name);
+			}
+			if(auto it=labels.find(name);it!=labels.end()){
+				return it->second;
+			}
+			return labels.emplace(name,Label{}).first->second;//first use of the name
+		}
+		template<typename T>
+		T number(std::string_view token){
+			bool neg=token.starts_with('-');
+			if(neg||token.starts_with('+')){
+				token.remove_prefix(1);
+			}
+			int base=10;
+			if(token.starts_with("0x")||token.starts_with("0X")){
+				base=16;
+				token.remove_prefix(2);
+			}else if(token.starts_with("0b")||token.starts_with("0B")){
+				base=2;
+				token.remove_prefix(2);
+			}
+			uintmax_t v=0;
+			auto [ptr,ec]=std::from_chars(token.data(),token.data()+token.size(),v,base);
+			if(ec!=std::errc{} || ptr!=token.data()+token.size() || token.empty()){
+				error("invalid number",token);
+			}
+			return static_cast<T>(neg?0-v:v);
+		}
+		static bool is_number(std::string_view token){
+			return !token.empty() && (std::isdigit(static_cast<unsigned char>(token[0]))||token[0]=='-'||token[0]=='+');
+		}
+		template<typename T>
+		T opt(std::string_view token){
+			if(token.empty()){
+				error("missing option",token);
+			}
+			if constexpr(std::is_enum_v<T>){
+				auto v=magic_enum::enum_cast<T>(token);
+				if(!v){
+					error("invalid option",token);
+				}
+				return *v;
+			}else{
+				return number<T>(token);
+			}
+		}
+		template<typename Raw>
+		Raw arg(std::string_view token){
+			if(token.empty()){
+				error("missing argument",token);
+			}
+			if(is_number(token)){
+				return Raw{number<uintmax_t>(token)};
+			}
+			return Raw{label(token)};
+		}
+		template<typename T>
+		static void handle(Parser& parser,Lexer& lex,Code& out){
+			using opts_t=T::opts_t;
+			using args_t=T::args_t;
+			T instr{};
+			[&]<size_t ...I>(std::index_sequence<I...>){
+				(instr.set_opt(I,InstrSetUtil::opt_bits(parser.opt<std::tuple_element_t<I,opts_t>>(lex.next()))),...);
+			}(std::make_index_sequence<std::tuple_size_v<opts_t>-1>{});
+			[&]<size_t ...I>(std::index_sequence<I...>){
+				std::tuple<typename args_t::template raw<I>...> args{parser.arg<typename args_t::template raw<I>>(lex.next())...};
+				out.add(std::apply(instr,args));
+			}(std::make_index_sequence<args_t::num>{});
+		}
+	};
+}
+#endif //SOASM_PARSER_HPP
@@ -1,3 +1,6 @@
 #include "soasm/soisv1/regs.hpp"
 #include "soasm/soisv1/instr_set.hpp"
-#include "soasm/soisv1/model.hpp"
\ No newline at end of file
+#include "soasm/soisv1/timing.hpp"
+#include "soasm/soisv1/flow.hpp"
+#include "soasm/soisv1/model.hpp"
+#include "soasm/soisv1/debugger.hpp"
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef SOASM_SOISV1_DEBUGGER_HPP
+#define SOASM_SOISV1_DEBUGGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitset>
+#include <vector>
+#include <functional>
+#include <optional>
+#include "model.hpp"
+
+//Breakpoints and memory watchpoints for a Context.
+//Breakpoints cost one bit test per step, watchpoints cost nothing on pages without watches.
+namespace SOASM::SOISv1{
+	struct Debugger{
+		enum struct Event{
+			Breakpoint,
+			Read,
+			Write,
+		};
+		struct Hit{
+			Event event;
+			uint16_t pc;//of the instruction
+			uint16_t addr;//accessed address, pc for breakpoints
+			uint8_t value;//read or written value
+		};
+		struct Watch{
+			size_t begin,end;
+			bool read,write;
+		};
+		//return true to stop
+		using callback_t=std::function<bool(const Hit&,const InstrSet::record_ts&)>;
+
+		Context& ctx;
+		callback_t on_hit;
+		std::bitset<Context::mem_size> breakpoints{};
+		std::vector<Watch> watches{};
+		bool halted=false;
+
+		Debugger(Context& ctx,callback_t on_hit);
+		Debugger(const Debugger&)=delete;
+		Debugger& operator=(const Debugger&)=delete;
+		~Debugger();
+
+		void break_at(uint16_t addr,bool enable=true){
+			breakpoints[addr]=enable;
+		}
+		void watch(size_t begin,size_t end,bool read,bool write);
+		//run at most max_steps instructions, until halt or the callback asks to stop, return steps run.
+		//The breakpoint that stopped the last run does not stop again, so a stopped run can be resumed by calling it again.
+		size_t run(size_t max_steps=SIZE_MAX);
+	private:
+		using Memory=decltype(Context::mem);
+		//hook and watched pages of the memory before attaching, restored when detaching
+		std::function<void(size_t,uint8_t,bool)> prev_on_watch;
+		std::vector<bool> prev_watched;
+		std::vector<Hit> pending{};
+		uint16_t step_pc=0;
+		std::optional<uint16_t> stopped_at{};
+		InstrSet::record_ts record(uint16_t pc) const;
+	};
+} // SOASM::SOISv1
+
+#endif //SOASM_SOISV1_DEBUGGER_HPP
@@ -0,0 +1,49 @@
+#ifndef SOASM_SOISV1_FLOW_HPP
+#define SOASM_SOISV1_FLOW_HPP
+
+#include <array>
+#include <utility>
+#include "../cfg.hpp"
+#include "instr_set.hpp"
+
+namespace SOASM::SOISv1{
+	template<typename T>
+	FlowInfo flow(const T&,const typename T::args_t::raws_t&){
+		return {Flow::Next};
+	}
+	inline FlowInfo flow(const Jump&,const std::tuple<uint16_t>& args){
+		return {Flow::Jump,std::get<0>(args)};
+	}
+	inline FlowInfo flow(const BranchZero&,const std::tuple<uint16_t>& args){
+		return {Flow::Branch,std::get<0>(args)};
+	}
+	inline FlowInfo flow(const Call&,const std::tuple<uint16_t>& args){
+		return {Flow::Call,std::get<0>(args)};
+	}
+	inline FlowInfo flow(const CallPtr&,const std::tuple<>&){
+		return {Flow::CallIndirect};
+	}
+	inline FlowInfo flow(const Return&,const std::tuple<>&){
+		return {Flow::Return};
+	}
+	inline FlowInfo flow(const Reset& instr,const std::tuple<>&){
+		return {Flow::Jump,std::to_underlying(instr.val)<<2};
+	}
+	inline FlowInfo flow(const Halt&,const std::tuple<>&){
+		return {Flow::Stop};
+	}
+	inline FlowInfo flow(const Unknown&,const std::tuple<>&){
+		return {Flow::Stop};
+	}
+
+	//entry points of Reset instructions
+	inline constexpr auto reset_vectors=[]{
+		std::array<size_t,magic_enum::enum_count<Reset::Val>()> addrs{};
+		for(size_t i=0;i<addrs.size();++i){
+			addrs[i]=i<<2;
+		}
+		return addrs;
+	}();
+} // SOASM::SOISv1
+
+#endif //SOASM_SOISV1_FLOW_HPP
@@ -0,0 +1,96 @@
+#ifndef SOASM_SOISV1_FUZZ_HPP
+#define SOASM_SOISV1_FUZZ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <span>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <optional>
+#include <functional>
+#include "model.hpp"
+
+//Coverage guided fuzzing of a firmware image, inputs are written to memory and the image runs until Halt.
+namespace SOASM::SOISv1::Fuzz{
+	using image_t=std::array<uint8_t,Context::mem_size>;
+	using coverage_t=std::array<uint8_t,Context::coverage_size>;
+
+	enum struct Result{
+		Ok,
+		Crash,//Unknown opcode executed or crashed returned true
+		Hang,//no Halt within max_steps, or stuck on an instruction jumping to itself
+	};
+
+	struct Target{
+		const image_t& image;
+		uint16_t input_addr;
+		std::optional<uint16_t> length_addr{};//input length is stored here as u16 if set
+		size_t max_input=256;
+		uint16_t entry=0;
+		uint16_t sp=0;
+		size_t max_steps=1uz<<16;
+		std::function<bool(const Context&)> crashed{};
+
+		Result execute(std::span<const uint8_t> input,uint8_t* coverage=nullptr) const;
+	};
+
+	//AFL style havoc mutations, inputs are kept within max_input
+	struct Mutator{
+		std::mt19937_64 rng;
+		size_t max_input;
+
+		explicit Mutator(size_t max_input,uint64_t seed=0):rng(seed),max_input(max_input){}
+		void mutate(bytes_t& input,std::span<const uint8_t> other={});
+	private:
+		size_t below(size_t n){
+			return n==0?0:std::uniform_int_distribution<size_t>(0,n-1)(rng);
+		}
+	};
+
+	//Inputs that found new coverage, and the unique crashing and hanging ones.
+	//Hit counts are compared in AFL buckets, so a loop running more times counts as new coverage.
+	struct Corpus{
+		std::vector<bytes_t> inputs{};
+		std::vector<bytes_t> crashes{};
+		std::vector<bytes_t> hangs{};
+
+		explicit Corpus(std::vector<bytes_t> seeds={});
+		//merge coverage of a run, return true if it has new bits
+		bool update(const coverage_t& coverage,Result result);
+		//record the input if its coverage has new bits, return true if it was recorded
+		bool add(std::span<const uint8_t> input,const coverage_t& coverage,Result result);
+		bytes_t pick(std::mt19937_64& rng) const;
+		size_t size() const;
+		size_t edges() const;
+	private:
+		mutable std::mutex mutex{};
+		std::array<coverage_t,3> virgin{};//seen buckets for each Result
+		bool has_new(const coverage_t& coverage,Result result) const;
+		static uint8_t bucket(uint8_t count);
+	};
+
+	struct Options{
+		size_t threads=std::thread::hardware_concurrency();
+		uint64_t max_execs=1'000'000;
+		uint64_t seed=0;
+		bool minimize=true;//minimize crashes and hangs when done
+	};
+	struct Stats{
+		uint64_t execs=0;
+		size_t corpus=0;
+		size_t edges=0;
+		size_t crashes=0;
+		size_t hangs=0;
+	};
+
+	//Run one Context per thread until max_execs inputs were executed
+	Stats run(const Target& target,Corpus& corpus,const Options& opts={});
+
+	//Shrink input while it still gives the same result, by removing blocks then zeroing bytes
+	bytes_t minimize(const Target& target,bytes_t input,Result result);
+} // SOASM::SOISv1::Fuzz
+
+#endif //SOASM_SOISV1_FUZZ_HPP
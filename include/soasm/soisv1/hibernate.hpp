@@ -0,0 +1,47 @@
+#ifndef SOASM_SOISV1_HIBERNATE_HPP
+#define SOASM_SOISV1_HIBERNATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory>
+#include "model.hpp"
+
+//Compact image of a paused Context, to keep many idle machines without their overlay maps.
+//	Header | Page[] | page data
+//Page data is the bytes of one page differing from the base, as runs of
+//	skip(8) | fill(1) length-1(7) | value if fill, else length bytes
+//where skip counts unchanged bytes before the run. Shared regions, io ranges, watches and coverage are not saved.
+namespace SOASM::SOISv1{
+	struct Hibernated{
+		static constexpr uint32_t magic=0x42494853;//"SHIB"
+		static constexpr uint16_t version=1;
+		struct Header{
+			uint32_t magic;
+			uint16_t version;
+			uint16_t flags;//CF, illegal
+			uint8_t regs[8];
+			uint16_t sp;
+			uint16_t pc;
+			uint32_t page_count;
+			uint64_t cycles;
+		};
+		struct Page{
+			uint16_t page;
+			uint16_t size;
+			uint32_t offset;//of page data in blob
+		};
+		enum Flags:uint16_t{
+			CF=1,
+			Illegal=2,
+		};
+	};
+
+	//registers and memory of ctx, pages not restored yet are restored first
+	bytes_t hibernate(Context& ctx);
+	//Context on base with the state saved in blob, pages are decoded into the overlay on first access
+	//throw std::invalid_argument if blob is not a valid image
+	Context resume(const std::array<uint8_t,Context::mem_size>& base,std::shared_ptr<const bytes_t> blob);
+} // SOASM::SOISv1
+
+#endif //SOASM_SOISV1_HIBERNATE_HPP
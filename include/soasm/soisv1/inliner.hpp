@@ -0,0 +1,36 @@
+#ifndef SOASM_SOISV1_INLINER_HPP
+#define SOASM_SOISV1_INLINER_HPP
+
+#include <cstddef>
+#include <map>
+#include <span>
+#include "../asm.hpp"
+#include "instr_set.hpp"
+
+//Inliner for routines given as CodeBlocks, a routine is called with Call start and returns with Return.
+//Calls of small leaf routines are replaced by a copy of the body, with labels of the body cloned for every copy and
+//every Return jumping to the end of the copy. If the callee uses Enter, Leave or Adjust, the copy is wrapped in
+//Adjust -2 and Adjust 2, so the frame has the same layout as with the return address on the stack.
+//Call x;Return becomes Jump x, so x returns to the caller of the current routine.
+//Callees must not read the stack above their return address or pop their return address.
+namespace SOASM::SOISv1::Inliner{
+	using decoded_t=Decoded<InstrSet>;
+	using instr_t=decoded_t::Instr;
+
+	struct Options{
+		size_t max_size=16;//bytes of a callee body, not counting its last Return
+		bool tail_calls=true;
+	};
+	struct Report{
+		size_t inlined=0;//call sites replaced by the callee
+		size_t tail_calls=0;//Call;Return rewritten as Jump
+		ptrdiff_t bytes_saved=0;//negative when inlining grew the code
+		ptrdiff_t cycles_saved=0;//estimated, per execution of every rewritten site
+		std::map<size_t,size_t> sites{};//index of callee in routines to call sites inlined
+	};
+
+	//rewrite bodies of routines in place, the routines stay, as they may still be called indirectly
+	Report optimize(std::span<CodeBlock> routines,const Options& opts={});
+} // SOASM::SOISv1::Inliner
+
+#endif //SOASM_SOISV1_INLINER_HPP
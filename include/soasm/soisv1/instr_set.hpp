@@ -178,6 +178,29 @@ namespace SOASM::SOISv1{
 		#include "soasm/x_opts.inc"
 	};
 
+	//bulk memory, length(16) is popped from stack, pointers are not changed
+	struct MemCopy:Instr<MemCopy>{//copy length bytes from address(16) to address(16), regions may overlap
+		static constexpr raw_t reserve_id=0x60;
+		static constexpr std::string_view name="MemCopy";
+
+		#define X_OPTS X(Reg16,from) X(Reg16,to)
+		#include "soasm/x_opts.inc"
+	};
+	struct MemCompare:Instr<MemCompare>{//set CF if length bytes at both addresses(16) are equal
+		static constexpr raw_t reserve_id=0x70;
+		static constexpr std::string_view name="MemCompare";
+
+		#define X_OPTS X(Reg16,from) X(Reg16,to)
+		#include "soasm/x_opts.inc"
+	};
+	struct MemFill:Instr<MemFill>{//pop value(8) after length and save it to length bytes from address(16)
+		static constexpr raw_t reserve_id=0x80;
+		static constexpr std::string_view name="MemFill";
+
+		#define X_OPTS X(Reg16,to)
+		#include "soasm/x_opts.inc"
+	};
+
 	struct Reset:Instr<Reset>{
 		static constexpr raw_t reserve_id=0x00;
 		static constexpr std::string_view name="Reset";
@@ -220,12 +243,12 @@ namespace SOASM::SOISv1{
 		Adjust,Enter,Leave,CallPtr,
 		PushCF,PopCF,
 		NOP,
+		MemCopy,MemCompare,MemFill,
 		Halt
 	>;
-} // SOASM::SOISv1
-namespace SOASM{
-	static inline Code instr_to_code(auto instr,const data_t& arg){
-		return {instr.template set_id<SOISv1::InstrSet>().to_raw(),arg};
+	//found by ADL from InstrBase::operator()
+	inline Code instr_to_code(auto instr,const data_t& arg){
+		return {instr.template set_id<InstrSet>().to_raw(),arg};
 	}
-}
+} // SOASM::SOISv1
 #endif //SOASM_SOISV1_INSTR_SET_HPP
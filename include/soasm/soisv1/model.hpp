@@ -7,7 +7,9 @@
 #include <map>
 #include <ranges>
 #include "soasm/models/memory.hpp"
+#include "soasm/models/executor.hpp"
 #include "instr_set.hpp"
+#include "timing.hpp"
 
 namespace SOASM::SOISv1{
 	struct Context{
@@ -18,10 +20,27 @@ namespace SOASM::SOISv1{
 		uint16_t pc=0;
 		bool CF=true;
 		Regs::RegFile reg;
+		uint64_t cycles=0;
+		bool illegal=false;//an Unknown opcode was executed
+		//AFL style edge coverage, hit counts of hashed (prev,pc) of every control transfer and not taken branch, if set
+		static constexpr size_t coverage_size=1uz<<16;
+		uint8_t* coverage=nullptr;
+		uint16_t prev_loc=0;
+		void cover(){
+			auto loc=static_cast<uint16_t>(pc*0x9e37u);//spread nearby addresses over the map
+			++coverage[(loc^prev_loc)%coverage_size];
+			prev_loc=loc>>1;
+		}
 
+		template<typename T>
+		static constexpr size_t cost=Timing::cycles<T>;
 		template<typename Instr,typename ...Args>
 		void run_instr(Instr,Args...);
 		bool run();
+		//co_await run_for(budget) in a Models::Task runs at most budget steps, stopping early after an io access
+		auto run_for(uint64_t budget){
+			return Models::run_for(*this,budget);
+		}
 
 		template<typename T>
 		T::type imm(){
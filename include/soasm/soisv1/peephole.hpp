@@ -0,0 +1,37 @@
+#ifndef SOASM_SOISV1_PEEPHOLE_HPP
+#define SOASM_SOISV1_PEEPHOLE_HPP
+
+#include <cstddef>
+#include <map>
+#include <span>
+#include <string_view>
+#include "../asm.hpp"
+#include "instr_set.hpp"
+
+//Peephole optimiser, rewrites short runs of instructions between labels
+namespace SOASM::SOISv1::Peephole{
+	using decoded_t=Decoded<InstrSet>;
+	using instr_t=decoded_t::Instr;
+
+	struct Options{
+		bool cf_dead=false;//allow rewrites that change CF
+		size_t max_passes=8;
+	};
+	struct Report{
+		size_t bytes_saved=0;
+		size_t cycles_saved=0;//estimated, per execution of every rewritten site
+		std::map<std::string_view,size_t> hits{};//times each rule applied
+	};
+	struct Rule{
+		std::string_view name;
+		size_t length;//instructions matched
+		//append replacement to out and return true if window matches
+		bool (*rewrite)(std::span<const instr_t> window,std::vector<instr_t>& out,const Options& opts);
+	};
+	extern const std::vector<Rule> rules;
+
+	Report optimize(decoded_t& code,const Options& opts={});
+	Code optimize(const Code& code,Report* report=nullptr,const Options& opts={});
+} // SOASM::SOISv1::Peephole
+
+#endif //SOASM_SOISV1_PEEPHOLE_HPP
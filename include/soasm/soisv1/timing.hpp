@@ -0,0 +1,46 @@
+#ifndef SOASM_SOISV1_TIMING_HPP
+#define SOASM_SOISV1_TIMING_HPP
+
+#include <cstddef>
+#include <variant>
+#include "instr_set.hpp"
+
+namespace SOASM::SOISv1::Timing{
+	//data memory accesses (in bytes) besides fetching the instruction itself
+	template<typename T>
+	inline constexpr size_t mem_access=0;
+
+	template<> inline constexpr size_t mem_access<LoadFar>    =2;//load + push
+	template<> inline constexpr size_t mem_access<SaveFar>    =2;//pop + save
+	template<> inline constexpr size_t mem_access<LoadNear>   =2;
+	template<> inline constexpr size_t mem_access<SaveNear>   =2;
+	template<> inline constexpr size_t mem_access<Load>       =2;
+	template<> inline constexpr size_t mem_access<Save>       =2;
+	template<> inline constexpr size_t mem_access<SaveImm>    =1;
+	template<> inline constexpr size_t mem_access<ImmVal>     =1;
+	template<> inline constexpr size_t mem_access<Calc>       =3;//pop 2 + push
+	template<> inline constexpr size_t mem_access<Logic>      =3;
+	template<> inline constexpr size_t mem_access<Push>       =1;
+	template<> inline constexpr size_t mem_access<Pop>        =1;
+	template<> inline constexpr size_t mem_access<BranchZero> =1;
+	template<> inline constexpr size_t mem_access<Call>       =2;//push return address(16)
+	template<> inline constexpr size_t mem_access<CallPtr>    =4;//pop address(16) + push return address(16)
+	template<> inline constexpr size_t mem_access<Return>     =2;
+	template<> inline constexpr size_t mem_access<Enter>      =2;
+	template<> inline constexpr size_t mem_access<Leave>      =2;
+	template<> inline constexpr size_t mem_access<PushCF>     =1;
+	template<> inline constexpr size_t mem_access<PopCF>      =1;
+	template<> inline constexpr size_t mem_access<MemCopy>    =2;//pop length(16), the bytes are counted when run
+	template<> inline constexpr size_t mem_access<MemCompare> =2;
+	template<> inline constexpr size_t mem_access<MemFill>    =3;
+
+	//one cycle to execute, one per fetched byte(opcode and args) and one per data memory access
+	template<typename T>
+	inline constexpr size_t cycles=1+T::size+mem_access<T>;
+
+	inline size_t cycles_of(const InstrSet::instr_ts& instr){
+		return std::visit([]<typename T>(T){return cycles<T>;},instr);
+	}
+} // SOASM::SOISv1::Timing
+
+#endif //SOASM_SOISV1_TIMING_HPP
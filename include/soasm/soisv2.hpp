@@ -0,0 +1,5 @@
+#include "soasm/soisv2/regs.hpp"
+#include "soasm/soisv2/instr_set.hpp"
+#include "soasm/soisv2/timing.hpp"
+#include "soasm/soisv2/model.hpp"
+#include "soasm/soisv2/translate.hpp"
\ No newline at end of file
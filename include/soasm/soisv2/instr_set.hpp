@@ -0,0 +1,274 @@
+
+#ifndef SOASM_SOISV2_INSTR_SET_HPP
+#define SOASM_SOISV2_INSTR_SET_HPP
+
+#include <cstddef>
+#include "../instr.hpp"
+#include "../instr_set_util.hpp"
+#include "regs.hpp"
+
+//16 bit register to register instruction set, the memory stack is kept for calls and SOISv1 compatibility
+namespace SOASM::SOISv2{
+	using namespace RawTypes;
+	using namespace Regs;
+
+	template<typename T,typename ...Args>
+	using Instr=InstrBase<LE::u16,T,Args...>;
+
+	struct Alu:Instr<Alu>{//dst=dst fn src
+		static constexpr std::string_view name="Alu";
+		enum struct FN:raw_t{
+			MOV,
+			ADD, SUB,//set CF
+			ADC, SUC,//use and set CF
+			AND, OR , XOR,
+		};
+
+		#define X_OPTS X(FN,fn) X(Reg,dst) X(Reg,src)
+		#include "soasm/x_opts.inc"
+	};
+	struct Alu16:Instr<Alu16>{//dst=dst fn src
+		static constexpr std::string_view name="Alu16";
+		enum struct FN:raw_t{
+			MOV,
+			ADD, SUB,//set CF
+		};
+
+		#define X_OPTS X(FN,fn) X(Reg16,dst) X(Reg16,src)
+		#include "soasm/x_opts.inc"
+	};
+	struct Unary:Instr<Unary>{//reg=fn reg
+		static constexpr std::string_view name="Unary";
+		enum struct FN:raw_t{
+			NOT,
+			SHL, SHR,//set CF
+			RCL, RCR,//use and set CF
+			INC, DEC,
+		};
+
+		#define X_OPTS X(FN,fn) X(Reg,reg)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Imm8:Instr<Imm8,u8>{
+		static constexpr std::string_view name="Imm8";
+
+		#define X_OPTS X(Reg,dst)
+		#include "soasm/x_opts.inc"
+	};
+	struct Imm16:Instr<Imm16,LE::u16>{
+		static constexpr std::string_view name="Imm16";
+
+		#define X_OPTS X(Reg16,dst)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Load:Instr<Load>{//load value(8) from address(16), PostInc increases address after access
+		static constexpr std::string_view name="Load";
+		enum struct Mode:raw_t{
+			Plain,
+			PostInc,
+		};
+
+		#define X_OPTS X(Mode,mode) X(Reg,dst) X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+	struct Store:Instr<Store>{//store value(8) to address(16), PostInc increases address after access
+		static constexpr std::string_view name="Store";
+		using Mode=Load::Mode;
+
+		#define X_OPTS X(Mode,mode) X(Reg,src) X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+	struct LoadOff:Instr<LoadOff,LE::i16>{//load value(8) from address(16) with offset(16)
+		static constexpr std::string_view name="LoadOff";
+
+		#define X_OPTS X(Reg,dst) X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+	struct StoreOff:Instr<StoreOff,LE::i16>{//store value(8) to address(16) with offset(16)
+		static constexpr std::string_view name="StoreOff";
+
+		#define X_OPTS X(Reg,src) X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+	struct StoreImm:Instr<StoreImm,u8>{//store immediate value(8) to address(16)
+		static constexpr std::string_view name="StoreImm";
+
+		#define X_OPTS X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Push:Instr<Push>{
+		static constexpr std::string_view name="Push";
+
+		#define X_OPTS X(Reg,from)
+		#include "soasm/x_opts.inc"
+	};
+	struct Pop:Instr<Pop>{
+		static constexpr std::string_view name="Pop";
+
+		#define X_OPTS X(Reg,to)
+		#include "soasm/x_opts.inc"
+	};
+	struct Push16:Instr<Push16>{
+		static constexpr std::string_view name="Push16";
+
+		#define X_OPTS X(Reg16,from)
+		#include "soasm/x_opts.inc"
+	};
+	struct Pop16:Instr<Pop16>{
+		static constexpr std::string_view name="Pop16";
+
+		#define X_OPTS X(Reg16,to)
+		#include "soasm/x_opts.inc"
+	};
+	struct PushImm:Instr<PushImm,u8>{//push immediate value to stack
+		static constexpr std::string_view name="PushImm";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+
+	struct BranchZero:Instr<BranchZero,LE::u16>{//jump if reg is zero
+		static constexpr std::string_view name="BranchZero";
+
+		#define X_OPTS X(Reg,reg)
+		#include "soasm/x_opts.inc"
+	};
+	struct Jump:Instr<Jump,LE::u16>{
+		static constexpr std::string_view name="Jump";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+	struct Call:Instr<Call,LE::u16>{
+		static constexpr std::string_view name="Call";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+	struct CallReg:Instr<CallReg>{//call address(16) in reg
+		static constexpr std::string_view name="CallReg";
+
+		#define X_OPTS X(Reg16,addr)
+		#include "soasm/x_opts.inc"
+	};
+	struct Return:Instr<Return>{
+		static constexpr std::string_view name="Return";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Adjust:Instr<Adjust,LE::i16>{
+		static constexpr std::string_view name="Adjust";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+	struct Enter:Instr<Enter>{
+		static constexpr std::string_view name="Enter";
+
+		#define X_OPTS X(Reg16,bp)
+		#include "soasm/x_opts.inc"
+	};
+	struct Leave:Instr<Leave>{
+		static constexpr std::string_view name="Leave";
+
+		#define X_OPTS X(Reg16,bp)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct PushCF:Instr<PushCF>{
+		static constexpr std::string_view name="PushCF";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+	struct PopCF:Instr<PopCF>{
+		static constexpr std::string_view name="PopCF";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+
+	//bulk memory, pointers and length are not changed
+	struct MemCopy:Instr<MemCopy>{//copy length bytes from address(16) to address(16), regions may overlap
+		static constexpr std::string_view name="MemCopy";
+
+		#define X_OPTS X(Reg16,from) X(Reg16,to) X(Reg16,len)
+		#include "soasm/x_opts.inc"
+	};
+	struct MemCompare:Instr<MemCompare>{//set CF if length bytes at both addresses(16) are equal
+		static constexpr std::string_view name="MemCompare";
+
+		#define X_OPTS X(Reg16,from) X(Reg16,to) X(Reg16,len)
+		#include "soasm/x_opts.inc"
+	};
+	struct MemFill:Instr<MemFill>{//save val to length bytes from address(16)
+		static constexpr std::string_view name="MemFill";
+
+		#define X_OPTS X(Reg16,to) X(Reg16,len) X(Reg,val)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct NOP:Instr<NOP>{
+		static constexpr std::string_view name="NOP";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Reset:Instr<Reset>{
+		static constexpr raw_t reserve_id=0x0000;
+		static constexpr std::string_view name="Reset";
+
+		enum struct Val:raw_t{
+			RST0,RST1,RST2,RST3,
+			RST4,RST5,RST6,RST7,
+		};
+
+		#define X_OPTS X(Val,val)
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Halt:Instr<Halt>{
+		static constexpr raw_t reserve_id=0xFFFF;
+		static constexpr std::string_view name="Halt";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+
+	struct Unknown:Instr<Unknown>{
+		static constexpr std::string_view name="Unknown";
+
+		#define X_OPTS
+		#include "soasm/x_opts.inc"
+	};
+	using InstrSet=InstrSetUtil::InstrSet<
+		Unknown,
+		Reset,
+		Alu,Alu16,Unary,
+		Imm8,Imm16,
+		Load,Store,
+		LoadOff,StoreOff,
+		StoreImm,
+		Push,Pop,
+		Push16,Pop16,
+		PushImm,
+		BranchZero,
+		Jump,Call,CallReg,Return,
+		Adjust,Enter,Leave,
+		PushCF,PopCF,
+		MemCopy,MemCompare,MemFill,
+		NOP,
+		Halt
+	>;
+	//found by ADL from InstrBase::operator()
+	inline Code instr_to_code(auto instr,const data_t& arg){
+		return {InstrSet::raw::to_bytes(instr.template set_id<InstrSet>().to_raw()),arg};
+	}
+} // SOASM::SOISv2
+#endif //SOASM_SOISV2_INSTR_SET_HPP
@@ -0,0 +1,55 @@
+#ifndef SOASM_SOISV2_MODEL_HPP
+#define SOASM_SOISV2_MODEL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <map>
+#include <ranges>
+#include "soasm/models/memory.hpp"
+#include "soasm/models/executor.hpp"
+#include "instr_set.hpp"
+#include "timing.hpp"
+
+namespace SOASM::SOISv2{
+	struct Context{
+		static constexpr size_t mem_size=1uz<<16;
+		Models::Memory<mem_size> mem;
+
+		uint16_t sp=0;
+		uint16_t pc=0;
+		bool CF=true;
+		Regs::RegFile reg;
+		uint64_t cycles=0;
+
+		template<typename T>
+		static constexpr size_t cost=Timing::cycles<T>;
+		template<typename Instr,typename ...Args>
+		void run_instr(Instr,Args...);
+		bool run();
+		//co_await run_for(budget) in a Models::Task runs at most budget steps, stopping early after an io access
+		auto run_for(uint64_t budget){
+			return Models::run_for(*this,budget);
+		}
+
+		//pc of the instruction after the current one, args are already skipped by run()
+		uint16_t next() const{
+			return pc+InstrSet::raw::size;
+		}
+		template<typename T>
+		T::type pop(){
+			std::array<uint8_t,T::size> data;
+			for(auto&& d:data){
+				d=mem.get(sp++);
+			}
+			return T::from_bytes(data);
+		}
+		template<typename T>
+		void push(T::type v){
+			for(auto d:T::to_bytes(v)|std::views::reverse){
+				mem.set(--sp,d);
+			}
+		}
+	};
+} // SOASM
+
+#endif //SOASM_SOISV2_MODEL_HPP
@@ -0,0 +1,57 @@
+#ifndef SOASM_SOISV2_REGS_HPP
+#define SOASM_SOISV2_REGS_HPP
+
+#include <utility>
+#include <cstdint>
+#include "../util/accessors_proxy.hpp"
+namespace SOASM::SOISv2::Regs{
+	//same order as SOISv1 registers, followed by temporaries
+	//underlying type is the raw type, so opts pack without padding
+	enum struct Reg:uint16_t{
+		A  ,B  ,
+		C  ,D  ,
+		E  ,F  ,
+		L  ,H  ,
+		T0 ,T1 ,
+		T2 ,T3 ,
+		T4 ,T5 ,
+		T6 ,T7 ,
+	};
+	enum struct Reg16:uint16_t{
+		BA,
+		DC,
+		FE,
+		HL,
+		T10,
+		T32,
+		T54,
+		T76,
+	};
+
+	inline auto toL(Reg16 reg16){
+		return static_cast<Reg>((std::to_underlying(reg16)<<1)+0);
+	}
+	inline auto toH(Reg16 reg16){
+		return static_cast<Reg>((std::to_underlying(reg16)<<1)+1);
+	}
+
+
+	struct RegFile:Util::AccessorsProxy<RegFile>{
+		uint8_t regs[16];
+		uint8_t get(Reg reg) const{
+			return regs[std::to_underlying(reg)];
+		}
+		void set(Reg reg,uint8_t v){
+			regs[std::to_underlying(reg)]=v;
+		}
+		uint16_t get(Reg16 reg16) const{
+			return static_cast<uint16_t>(get(toH(reg16))<<8)|get(toL(reg16));
+		}
+		void set(Reg16 reg16,uint16_t v){
+			set(toL(reg16),v&0xff);
+			set(toH(reg16),(v>>8)&0xff);
+		}
+	};
+}
+
+#endif //SOASM_SOISV2_REGS_HPP
@@ -0,0 +1,41 @@
+#ifndef SOASM_SOISV2_TIMING_HPP
+#define SOASM_SOISV2_TIMING_HPP
+
+#include <cstddef>
+#include <variant>
+#include "instr_set.hpp"
+
+namespace SOASM::SOISv2::Timing{
+	//data memory accesses (in bytes) besides fetching the instruction itself
+	template<typename T>
+	inline constexpr size_t mem_access=0;
+
+	template<> inline constexpr size_t mem_access<Load>       =1;
+	template<> inline constexpr size_t mem_access<Store>      =1;
+	template<> inline constexpr size_t mem_access<LoadOff>    =1;
+	template<> inline constexpr size_t mem_access<StoreOff>   =1;
+	template<> inline constexpr size_t mem_access<StoreImm>   =1;
+	template<> inline constexpr size_t mem_access<Push>       =1;
+	template<> inline constexpr size_t mem_access<Pop>        =1;
+	template<> inline constexpr size_t mem_access<Push16>     =2;
+	template<> inline constexpr size_t mem_access<Pop16>      =2;
+	template<> inline constexpr size_t mem_access<PushImm>    =1;
+	template<> inline constexpr size_t mem_access<Call>       =2;//push return address(16)
+	template<> inline constexpr size_t mem_access<CallReg>    =2;
+	template<> inline constexpr size_t mem_access<Return>     =2;
+	template<> inline constexpr size_t mem_access<Enter>      =2;
+	template<> inline constexpr size_t mem_access<Leave>      =2;
+	template<> inline constexpr size_t mem_access<PushCF>     =1;
+	template<> inline constexpr size_t mem_access<PopCF>      =1;
+
+	//one cycle to execute, one per fetched byte(opcode and args) and one per data memory access,
+	//bulk memory instructions add their bytes when run
+	template<typename T>
+	inline constexpr size_t cycles=1+T::size+mem_access<T>;
+
+	inline size_t cycles_of(const InstrSet::instr_ts& instr){
+		return std::visit([]<typename T>(T){return cycles<T>;},instr);
+	}
+} // SOASM::SOISv2::Timing
+
+#endif //SOASM_SOISV2_TIMING_HPP
@@ -0,0 +1,21 @@
+#ifndef SOASM_SOISV2_TRANSLATE_HPP
+#define SOASM_SOISV2_TRANSLATE_HPP
+
+#include <cstddef>
+#include "../types.hpp"
+
+//Translate SOISv1 code to SOISv2 code with the same behaviour.
+//Stack sequences whose values only pass through the stack, like Push A;Push B;Calc ADD;Pop C, become register
+//instructions, so those bytes are no longer written below sp. Everything else keeps using the memory stack with the
+//same layout, and temporaries T0..T7 are never live across translated SOISv1 instructions.
+//Code must contain only SOISv1 instructions and labels, see Decoded.
+namespace SOASM::SOISv2{
+	struct TranslateReport{
+		size_t instrs_in=0;
+		size_t instrs_out=0;
+		size_t folded=0;//SOISv1 instructions translated as part of a register sequence
+	};
+	Code translate(const Code& code,TranslateReport* report=nullptr);
+} // SOASM::SOISv2
+
+#endif //SOASM_SOISV2_TRANSLATE_HPP
@@ -0,0 +1,75 @@
+#ifndef SOASM_SYMBOLS_HPP
+#define SOASM_SYMBOLS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <format>
+#include "types.hpp"
+
+//Immutable index from address to the nearest symbol at or below it, built from a label table after assembling.
+//Addresses and names are kept in sorted arrays over one string table. A directory of the first symbol in every block
+//of addresses narrows each lookup to the few symbols of one block, and lookups never allocate.
+//Map file: all tables are arrays of little-endian records aligned to 4 bytes, like object files.
+//	Header | addr[] | name[] | string table
+namespace SOASM{
+	struct SymbolIndex{
+		static constexpr uint32_t magic=0x50414d53;//"SMAP"
+		static constexpr uint16_t version=1;
+		struct Header{
+			uint32_t magic;
+			uint16_t version;
+			uint16_t flags;
+			uint32_t count;
+			uint32_t strtab_size;
+			uint32_t addr_off;
+			uint32_t name_off;
+			uint32_t strtab_off;
+		};
+		struct Match{
+			std::string_view name;
+			size_t offset;//addr-address of symbol
+		};
+
+		SymbolIndex()=default;
+		//every label of labels that has an address, labels at the same address are ordered by name
+		explicit SymbolIndex(const Label::tbl_t& labels);
+
+		[[nodiscard]] size_t size() const{
+			return addrs.size();
+		}
+		[[nodiscard]] size_t addr(size_t i) const{
+			return addrs[i];
+		}
+		[[nodiscard]] std::string_view name(size_t i) const{
+			return {strtab.data()+names[i]};
+		}
+		//index of first symbol at or after addr
+		[[nodiscard]] size_t lower_bound(size_t addr) const;
+		//nearest symbol at or below addr, the first by name if several share its address
+		[[nodiscard]] std::optional<Match> lookup(size_t addr) const;
+		//write match as "name" or "name+0x12" to out
+		template<typename Out>
+		static Out format_to(Out out,const Match& match){
+			return match.offset?std::format_to(out,"{}+{:#x}",match.name,match.offset):std::format_to(out,"{}",match.name);
+		}
+
+		[[nodiscard]] bytes_t write() const;
+		//throw std::invalid_argument if file is not a valid map file
+		static SymbolIndex read(std::span<const uint8_t> file);
+	private:
+		std::vector<uint32_t> addrs{};
+		std::vector<uint32_t> names{};//offsets in strtab of null terminated names
+		std::string strtab{};
+		size_t block_bits=0;
+		std::vector<uint32_t> blocks{};//index of first symbol at or after block<<block_bits, and size() at the end
+
+		void build_blocks();
+	};
+} // SOASM
+
+#endif //SOASM_SYMBOLS_HPP
@@ -16,9 +16,15 @@
 namespace SOASM{
 	struct Lazy{
 		using val_t=std::optional<size_t>;
+		enum struct Kind:uint8_t{
+			Custom,//fn is arbitrary
+			Absolute,//fn(addr,pc)=addr
+			Relative,//fn(addr,pc)=addr-pc
+		};
 		std::shared_ptr<val_t> ptr;
 		size_t offset;
 		std::function<uintmax_t(size_t,size_t)> fn;
+		Kind kind=Kind::Custom;
 		Lazy shift(ssize_t shift_offset) const{
 			Lazy lazy{*this};
 			lazy.offset+=shift_offset;
@@ -34,7 +40,7 @@ namespace SOASM{
 
 	struct Label{
 		using val_t=std::optional<size_t>;
-		using tbl_t=std::map<std::string,Label>;
+		using tbl_t=std::map<std::string,Label,std::less<>>;//looked up by string_view without a copy
 		static tbl_t tbl;
 
 		std::shared_ptr<val_t> ptr;
@@ -50,10 +56,10 @@ namespace SOASM{
 			return *ptr;
 		}
 		[[nodiscard]] Lazy lazy() const{
-			return Lazy{ptr,0,[](size_t addr,size_t pc){return addr;}};
+			return Lazy{ptr,0,[](size_t addr,size_t pc){return addr;},Lazy::Kind::Absolute};
 		}
 		[[nodiscard]] Lazy offset() const{
-			return Lazy{ptr,0,[](size_t addr,size_t pc){return addr-pc;}};
+			return Lazy{ptr,0,[](size_t addr,size_t pc){return addr-pc;},Lazy::Kind::Relative};
 		}
 	};
 
@@ -0,0 +1,181 @@
+#ifndef UTIL_METRICS_HPP
+#define UTIL_METRICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <format>
+
+//Counters and log2 histograms, sharded per thread so hot paths only do a relaxed add on their own cache line.
+//Metrics register themselves on construction and are exported as JSON or Prometheus text.
+namespace Util::Metrics{
+	inline constexpr size_t shards=16;
+	inline size_t shard(){
+		static std::atomic<size_t> next{0};
+		thread_local size_t index=next.fetch_add(1,std::memory_order_relaxed)%shards;
+		return index;
+	}
+	struct alignas(64) Cell{
+		std::atomic<uint64_t> value{0};
+	};
+
+	struct Counter;
+	struct Histogram;
+	struct Registry{
+		std::vector<const Counter*> counters{};
+		std::vector<const Histogram*> histograms{};
+
+		static Registry& instance(){
+			static Registry registry;
+			return registry;
+		}
+	};
+
+	struct Counter{
+		std::string_view name,help;
+		std::array<Cell,shards> cells{};
+
+		Counter(std::string_view name,std::string_view help):name(name),help(help){
+			Registry::instance().counters.push_back(this);
+		}
+		void add(uint64_t v){
+			cells[shard()].value.fetch_add(v,std::memory_order_relaxed);
+		}
+		[[nodiscard]] uint64_t value() const{
+			uint64_t sum=0;
+			for(auto& cell:cells){
+				sum+=cell.value.load(std::memory_order_relaxed);
+			}
+			return sum;
+		}
+	};
+
+	//bucket i counts values with bit_width i, that is values up to 2^i-1
+	struct Histogram{
+		static constexpr size_t buckets=65;
+		struct alignas(64) Shard{
+			std::array<std::atomic<uint64_t>,buckets> counts{};
+			std::atomic<uint64_t> sum{0};
+		};
+		std::string_view name,help;
+		std::array<Shard,shards> data{};
+
+		Histogram(std::string_view name,std::string_view help):name(name),help(help){
+			Registry::instance().histograms.push_back(this);
+		}
+		void observe(uint64_t v){
+			auto& s=data[shard()];
+			s.counts[std::bit_width(v)].fetch_add(1,std::memory_order_relaxed);
+			s.sum.fetch_add(v,std::memory_order_relaxed);
+		}
+		[[nodiscard]] std::array<uint64_t,buckets> counts() const{
+			std::array<uint64_t,buckets> ret{};
+			for(auto& s:data){
+				for(size_t i=0;i<buckets;++i){
+					ret[i]+=s.counts[i].load(std::memory_order_relaxed);
+				}
+			}
+			return ret;
+		}
+		[[nodiscard]] uint64_t sum() const{
+			uint64_t ret=0;
+			for(auto& s:data){
+				ret+=s.sum.load(std::memory_order_relaxed);
+			}
+			return ret;
+		}
+	};
+
+	//observe nanoseconds until destruction, nothing if histogram is null
+	struct Timer{
+		Histogram* histogram;
+		std::chrono::steady_clock::time_point start{};
+
+		explicit Timer(Histogram* histogram):histogram(histogram){
+			if(histogram){
+				start=std::chrono::steady_clock::now();
+			}
+		}
+		~Timer(){
+			if(histogram){
+				histogram->observe(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count());
+			}
+		}
+	};
+
+	inline std::string to_json(const Registry& registry=Registry::instance()){
+		std::string out="{\"counters\":{";
+		for(size_t i=0;i<registry.counters.size();++i){
+			auto c=registry.counters[i];
+			out+=std::format("{}\"{}\":{}",i?",":"",c->name,c->value());
+		}
+		out+="},\"histograms\":{";
+		for(size_t i=0;i<registry.histograms.size();++i){
+			auto h=registry.histograms[i];
+			auto counts=h->counts();
+			uint64_t count=0;
+			out+=std::format("{}\"{}\":{{\"buckets\":[",i?",":"",h->name);
+			for(size_t b=0;b<counts.size();++b){
+				out+=std::format("{}{}",b?",":"",counts[b]);
+				count+=counts[b];
+			}
+			out+=std::format("],\"count\":{},\"sum\":{}}}",count,h->sum());
+		}
+		out+="}}";
+		return out;
+	}
+
+	inline std::string to_prometheus(const Registry& registry=Registry::instance()){
+		std::string out;
+		for(auto c:registry.counters){
+			out+=std::format("# HELP {0} {1}\n# TYPE {0} counter\n{0} {2}\n",c->name,c->help,c->value());
+		}
+		for(auto h:registry.histograms){
+			out+=std::format("# HELP {0} {1}\n# TYPE {0} histogram\n",h->name,h->help);
+			auto counts=h->counts();
+			uint64_t count=0;
+			for(size_t b=0;b<counts.size();++b){
+				count+=counts[b];
+				if(counts[b] && b<64){
+					out+=std::format("{}_bucket{{le=\"{}\"}} {}\n",h->name,(1ull<<b)-1,count);
+				}
+			}
+			out+=std::format("{0}_bucket{{le=\"+Inf\"}} {1}\n{0}_sum {2}\n{0}_count {1}\n",h->name,count,h->sum());
+		}
+		return out;
+	}
+} // Util::Metrics
+
+#define SOASM_METRIC_CONCAT_IMPL(a,b) a##b
+#define SOASM_METRIC_CONCAT(a,b) SOASM_METRIC_CONCAT_IMPL(a,b)
+
+//Metrics are declared and touched only through these macros, so they compile to nothing without SOASM_ENABLE_METRICS
+#ifdef SOASM_ENABLE_METRICS
+#define SOASM_METRIC_COUNTER(id,name,help) inline ::Util::Metrics::Counter id{name,help}
+#define SOASM_METRIC_HISTOGRAM(id,name,help) inline ::Util::Metrics::Histogram id{name,help}
+#define SOASM_METRIC_ADD(metric,v) (metric).add(v)
+#define SOASM_METRIC_INC(metric) (metric).add(1)
+#define SOASM_METRIC_OBSERVE(metric,v) (metric).observe(v)
+#define SOASM_METRIC_TIME(metric) ::Util::Metrics::Timer SOASM_METRIC_CONCAT(metric_timer_,__LINE__){&(metric)}
+//time one in every period executions of the enclosing scope
+#define SOASM_METRIC_TIME_SAMPLED(metric,period) \
+	static thread_local uint32_t SOASM_METRIC_CONCAT(metric_tick_,__LINE__)=0; \
+	::Util::Metrics::Timer SOASM_METRIC_CONCAT(metric_timer_,__LINE__){ \
+		++SOASM_METRIC_CONCAT(metric_tick_,__LINE__)%(period)==0?&(metric):nullptr}
+#else
+#define SOASM_METRIC_COUNTER(id,name,help) static_assert(true)
+#define SOASM_METRIC_HISTOGRAM(id,name,help) static_assert(true)
+#define SOASM_METRIC_ADD(metric,v) ((void)0)
+#define SOASM_METRIC_INC(metric) ((void)0)
+#define SOASM_METRIC_OBSERVE(metric,v) ((void)0)
+#define SOASM_METRIC_TIME(metric) ((void)0)
+#define SOASM_METRIC_TIME_SAMPLED(metric,period) ((void)0)
+#endif
+
+#endif //UTIL_METRICS_HPP
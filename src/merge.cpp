@@ -0,0 +1,194 @@
+#include <soasm/merge.hpp>
+#include <soasm/util/overloaded.hpp>
+#include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+
+using namespace SOASM;
+
+namespace{
+	//canonical form of a block, equal for blocks that may share one copy
+	struct Canonical{
+		std::vector<uintmax_t> tokens{};
+		std::vector<Label> labels{};//defined in the block, in order
+		size_t hash=0;
+	};
+	enum Token:uintmax_t{
+		Byte,
+		Define,
+		Internal,//lazy of a label defined in the block
+		External,
+	};
+}
+
+static std::optional<Canonical> canonical(const Code& code){
+	Canonical ret;
+	std::unordered_map<const Label::val_t*,size_t> index;
+	for (const auto &val:code) {
+		if(auto label=std::get_if<Label>(&val)){
+			if(label->get()){//fixed address
+				return std::nullopt;
+			}
+			if(index.try_emplace(label->ptr.get(),ret.labels.size()).second){
+				ret.labels.push_back(*label);
+			}
+		}
+	}
+	bool mergeable=true;
+	for (const auto &val:code) {
+		std::visit(Util::overloaded{
+			[&](uint8_t byte){
+				ret.tokens.insert(ret.tokens.end(),{Byte,byte});
+			},
+			[&](const Label& label){
+				ret.tokens.insert(ret.tokens.end(),{Define,index.at(label.ptr.get())});
+			},
+			[&](const Lazy& lazy){
+				if(lazy.kind==Lazy::Kind::Custom || !lazy.ptr){
+					mergeable=false;
+					return;
+				}
+				auto kind=std::to_underlying(lazy.kind);
+				if(auto it=index.find(lazy.ptr.get());it!=index.end()){
+					ret.tokens.insert(ret.tokens.end(),{Internal,kind,lazy.offset,it->second});
+				}else{
+					ret.tokens.insert(ret.tokens.end(),{External,kind,lazy.offset,reinterpret_cast<uintptr_t>(lazy.ptr.get())});
+				}
+			},
+		},val);
+	}
+	if(!mergeable){
+		return std::nullopt;
+	}
+	ret.hash=ret.tokens.size();
+	for (auto token:ret.tokens) {
+		ret.hash^=std::hash<uintmax_t>{}(token)+0x9e3779b97f4a7c15+(ret.hash<<6)+(ret.hash>>2);
+	}
+	return ret;
+}
+
+//keep the first of every group of identical blocks, return which blocks are kept
+static std::vector<bool> fold(std::span<const Code> blocks,const std::vector<bool>& foldable,Merged& merged,size_t& folded){
+	std::vector<bool> kept(blocks.size(),true);
+	std::vector<std::optional<Canonical>> forms;
+	forms.reserve(blocks.size());
+	std::unordered_multimap<size_t,size_t> by_hash;
+	for (size_t i=0;i<blocks.size();++i) {
+		auto& form=forms.emplace_back(canonical(blocks[i]));
+		if(!form){
+			continue;
+		}
+		auto [begin,end]=by_hash.equal_range(form->hash);
+		auto same=std::find_if(begin,end,[&](const auto& entry){return forms[entry.second]->tokens==form->tokens;});
+		if(same==end){
+			by_hash.emplace(form->hash,i);
+			continue;
+		}
+		if(!foldable[i]){
+			continue;
+		}
+		auto& target=*forms[same->second];
+		for (size_t l=0;l<form->labels.size();++l) {
+			merged.aliases.emplace_back(form->labels[l],target.labels[l]);
+		}
+		kept[i]=false;
+		++folded;
+		merged.report.bytes_saved+=blocks[i].size();
+	}
+	return kept;
+}
+
+Merged SOASM::merge(std::span<const CodeBlock> code, std::span<const DataBlock> data, const Terminated& terminated) {
+	Merged merged;
+	std::vector<Code> code_blocks,data_blocks;
+	for (const auto &block:code) {
+		code_blocks.push_back(block.to_code());
+	}
+	for (const auto &block:data) {
+		data_blocks.push_back(block.to_code());
+	}
+	//a code block may go only if nothing falls into it or out of it
+	std::vector<bool> code_foldable(code.size(),false);
+	bool prev=true;
+	for (size_t i=0;terminated && i<code.size();++i) {
+		bool ends=terminated(code[i]);
+		code_foldable[i]=prev && ends;
+		prev=ends;
+	}
+	auto code_kept=fold(code_blocks,code_foldable,merged,merged.report.code_folded);
+	auto data_kept=fold(data_blocks,std::vector<bool>(data.size(),true),merged,merged.report.data_folded);
+
+	//suffixes: sorted by reversed contents, a block is a suffix of the next one if its reversed contents are a prefix
+	std::vector<std::pair<size_t,bytes_t>> plain;
+	for (size_t i=0;i<data.size();++i) {
+		if(!data_kept[i] || data[i].body.empty() || data[i].start.get() || data[i].end.get()){
+			continue;
+		}
+		bytes_t reversed;
+		reversed.reserve(data[i].body.size());
+		for (const auto &val:data[i].body|std::views::reverse) {
+			auto byte=std::get_if<uint8_t>(&val);
+			if(!byte){
+				break;
+			}
+			reversed.push_back(*byte);
+		}
+		if(reversed.size()==data[i].body.size()){
+			plain.emplace_back(i,std::move(reversed));
+		}
+	}
+	std::ranges::sort(plain,{},[](const auto& entry)->const bytes_t&{return entry.second;});
+	std::vector<std::vector<std::pair<size_t,Label>>> inside(data.size());//labels to insert into a host, by offset
+	std::vector<size_t> host_of(data.size());
+	std::iota(host_of.begin(),host_of.end(),0uz);
+	for (size_t j=plain.size();j-->1;) {
+		const auto& [i,reversed]=plain[j-1];
+		const auto& [next,next_reversed]=plain[j];
+		if(next_reversed.size()<reversed.size() || !std::equal(reversed.begin(),reversed.end(),next_reversed.begin())){
+			continue;
+		}
+		auto host=host_of[i]=host_of[next];//next may be placed in a longer one already
+		Label at;
+		inside[host].emplace_back(data[host].body.size()-reversed.size(),at);
+		merged.aliases.emplace_back(data[i].start,at);
+		merged.aliases.emplace_back(data[i].end,data[host].end);
+		data_kept[i]=false;
+		++merged.report.data_suffixes;
+		merged.report.bytes_saved+=reversed.size();
+	}
+
+	for (size_t i=0;i<code.size();++i) {
+		if(code_kept[i]){
+			merged.code.add(code_blocks[i]);
+		}
+	}
+	for (size_t i=0;i<data.size();++i) {
+		if(!data_kept[i]){
+			continue;
+		}
+		if(inside[i].empty()){
+			merged.code.add(data_blocks[i]);
+			continue;
+		}
+		std::ranges::sort(inside[i],{},[](const auto& entry){return entry.first;});
+		merged.code.add(data[i].start);
+		auto label=inside[i].begin();
+		for (size_t pos=0;pos<data[i].body.size();++pos) {
+			for(;label!=inside[i].end() && label->first==pos;++label){
+				merged.code.add(label->second);
+			}
+			merged.code.add(data[i].body[pos]);
+		}
+		merged.code.add(data[i].end);
+	}
+	return merged;
+}
+
+data_t Merged::resolve(size_t start, uint8_t padding) const {
+	auto data=code.resolve(start,padding);
+	for (const auto &[label,target]:aliases|std::views::reverse) {//targets of an alias are only aliased before it
+		label.set(*target.get());
+	}
+	return data;
+}
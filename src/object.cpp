@@ -0,0 +1,240 @@
+#include <soasm/object.hpp>
+#include <soasm/util/overloaded.hpp>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+using namespace SOASM;
+using namespace SOASM::Object;
+
+bool View::valid() const {
+	if(file.size()<sizeof(Header)){
+		return false;
+	}
+	auto& h=header();
+	auto fits=[&](uint32_t offset,uint32_t count,size_t size){
+		return offset%4==0 && offset+uintmax_t{count}*size<=file.size();
+	};
+	if(!(h.magic==magic && h.version==version
+		 && fits(h.section_off,h.section_count,sizeof(Section))
+		 && fits(h.symbol_off,h.symbol_count,sizeof(Symbol))
+		 && fits(h.reloc_off,h.reloc_count,sizeof(Reloc))
+		 && fits(h.strtab_off,h.strtab_size,1))){
+		return false;
+	}
+	//names are read up to their null, so the string table must end with one
+	if(h.strtab_size==0 || file[h.strtab_off+h.strtab_size-1]!='\0'){
+		return false;
+	}
+	auto secs=sections();
+	auto syms=symbols();
+	auto valid_section=[&](const Section& sec){
+		return sec.name<h.strtab_size && uintmax_t{sec.data_off}+sec.size<=file.size();
+	};
+	auto valid_symbol=[&](const Symbol& sym){
+		return sym.name<h.strtab_size
+			&& (sym.section<secs.size() || sym.section==Symbol::External || sym.section==Symbol::Absolute);
+	};
+	auto valid_reloc=[&](const Reloc& reloc){
+		return reloc.section<secs.size() && reloc.offset<secs[reloc.section].size && reloc.symbol<syms.size()
+			&& (reloc.kind==Lazy::Kind::Absolute || reloc.kind==Lazy::Kind::Relative)
+			&& reloc.shift<sizeof(uintmax_t)*CHAR_BIT;
+	};
+	return std::ranges::all_of(secs,valid_section)
+		&& std::ranges::all_of(syms,valid_symbol)
+		&& std::ranges::all_of(relocs(),valid_reloc);
+}
+
+std::string Writer::name_of(const Label &label) const {
+	for (const auto &[name,l]:names) {
+		if(l.ptr==label.ptr){
+			return name;
+		}
+	}
+	return {};
+}
+
+bytes_t Writer::write() const {
+	std::unordered_map<const Label::val_t*,std::string_view> name_tbl;
+	for (const auto &[name,label]:names) {
+		name_tbl.try_emplace(label.ptr.get(),name);
+	}
+	std::string strtab(1,'\0');
+	auto add_str=[&](std::string_view str)->uint32_t{
+		if(str.empty()){
+			return 0;
+		}
+		auto offset=strtab.size();
+		strtab.append(str).push_back('\0');
+		return offset;
+	};
+
+	std::vector<Section> secs;
+	std::vector<Symbol> syms;
+	std::vector<Reloc> relocs;
+	std::vector<bytes_t> datas;
+	std::unordered_map<const Label::val_t*,uint32_t> symbol_of;
+
+	//labels first, so references may go forward and across sections
+	for (uint32_t i=0;i<sections.size();++i) {
+		const auto &[sec_name,code]=sections[i];
+		Section sec{add_str(sec_name),0,0,none};
+		size_t pos=0;
+		for (const auto &val:code) {
+			auto label=std::get_if<Label>(&val);
+			if(!label){
+				++pos;
+				continue;
+			}
+			if(auto addr=label->get();addr){
+				if(pos==0 && sec.addr==none){
+					sec.addr=*addr;
+				}else if(sec.addr!=none && *addr>=sec.addr+pos){
+					pos=*addr-sec.addr;
+				}else{
+					throw std::invalid_argument("fixed label inside relocatable section "+sec_name);
+				}
+			}
+			auto it=name_tbl.find(label->ptr.get());
+			if(symbol_of.try_emplace(label->ptr.get(),syms.size()).second){
+				syms.emplace_back(add_str(it==name_tbl.end()?"":it->second),i,pos);
+			}
+		}
+		sec.size=pos;
+		secs.push_back(sec);
+	}
+
+	for (uint32_t i=0;i<sections.size();++i) {
+		const auto &[sec_name,code]=sections[i];
+		auto& data=datas.emplace_back();
+		data.reserve(secs[i].size);
+		for (const auto &val:code) {
+			std::visit(Util::overloaded{
+				[&](uint8_t v) { data.push_back(v); },
+				[&](const Label& label) {
+					if(auto addr=label.get();addr && secs[i].addr!=none){
+						data.resize(*addr-secs[i].addr,0xff);
+					}
+				},
+				[&](const Lazy& lazy) {
+					if(lazy.kind==Lazy::Kind::Custom || !lazy.ptr){
+						throw std::invalid_argument("value in section "+sec_name+" is not relocatable");
+					}
+					auto key=lazy.ptr.get();
+					auto [it,inserted]=symbol_of.try_emplace(key,syms.size());
+					if(inserted){
+						if(*lazy.ptr){
+							syms.emplace_back(0,Symbol::Absolute,static_cast<uint32_t>(**lazy.ptr));
+						}else if(auto name=name_tbl.find(key);name!=name_tbl.end()){
+							syms.emplace_back(add_str(name->second),Symbol::External,0);
+						}else{
+							throw std::invalid_argument("unnamed label used in section "+sec_name+" is not defined");
+						}
+					}
+					relocs.emplace_back(i,data.size(),it->second,lazy.kind,static_cast<uint8_t>(lazy.offset),0);
+					data.push_back(0);
+				},
+			},val);
+		}
+	}
+
+	auto align=[](size_t v){return (v+3)&~size_t{3};};
+	Header header{magic,version,0,
+		static_cast<uint32_t>(secs.size()),static_cast<uint32_t>(syms.size()),
+		static_cast<uint32_t>(relocs.size()),static_cast<uint32_t>(strtab.size())};
+	size_t offset=sizeof(Header);
+	header.section_off=offset; offset+=secs.size()*sizeof(Section);
+	header.symbol_off=offset;  offset+=syms.size()*sizeof(Symbol);
+	header.reloc_off=offset;   offset+=relocs.size()*sizeof(Reloc);
+	header.strtab_off=offset;  offset=align(offset+strtab.size());
+	for (size_t i=0;i<secs.size();++i) {
+		secs[i].data_off=offset;
+		offset+=datas[i].size();
+	}
+
+	bytes_t file(offset,0);
+	auto put=[&](size_t at,const void* src,size_t n){
+		if(n>0){
+			std::memcpy(file.data()+at,src,n);
+		}
+	};
+	put(0,&header,sizeof(Header));
+	put(header.section_off,secs.data(),secs.size()*sizeof(Section));
+	put(header.symbol_off,syms.data(),syms.size()*sizeof(Symbol));
+	put(header.reloc_off,relocs.data(),relocs.size()*sizeof(Reloc));
+	put(header.strtab_off,strtab.data(),strtab.size());
+	for (size_t i=0;i<secs.size();++i) {
+		put(secs[i].data_off,datas[i].data(),datas[i].size());
+	}
+	return file;
+}
+
+bytes_t Linker::link(std::span<const View> objects) const {
+	struct Pending{
+		size_t pos;
+		std::string_view name;
+		Lazy::Kind kind;
+		uint8_t shift;
+	};
+	static constexpr size_t unresolved=SIZE_MAX;
+	bytes_t out;
+	std::unordered_map<std::string_view,size_t> globals;
+	std::vector<Pending> pending;
+	std::vector<size_t> bases,addrs;
+
+	auto patch=[&](size_t pos,size_t addr,Lazy::Kind kind,uint8_t shift){
+		uintmax_t v=kind==Lazy::Kind::Relative?addr-pos:addr;
+		out[pos]=(v>>shift)&0xffull;
+	};
+	for (const auto &obj:objects) {
+		if(!obj.valid()){
+			throw std::invalid_argument("not a valid object file");
+		}
+		bases.clear();
+		for (const auto &sec:obj.sections()) {
+			size_t addr=sec.addr==none?start+out.size():sec.addr;
+			if(addr<start+out.size()){
+				throw std::runtime_error(std::string("section overlaps: ")+std::string(obj.name(sec.name)));
+			}
+			if(addr+sec.size>start+size){
+				throw std::length_error("image too large");
+			}
+			out.resize(addr-start,padding);
+			auto data=obj.data(sec);
+			out.insert(out.end(),data.begin(),data.end());
+			bases.push_back(addr);
+		}
+		auto symbols=obj.symbols();
+		addrs.assign(symbols.size(),unresolved);
+		for (size_t i=0;i<symbols.size();++i) {
+			const auto &sym=symbols[i];
+			if(sym.section==Symbol::External){
+				continue;
+			}
+			addrs[i]=sym.section==Symbol::Absolute?sym.value:bases[sym.section]+sym.value;
+			if(sym.name!=0 && sym.section!=Symbol::Absolute && !globals.emplace(obj.name(sym.name),addrs[i]).second){
+				throw std::runtime_error(std::string("duplicate symbol: ")+std::string(obj.name(sym.name)));
+			}
+		}
+		for (const auto &reloc:obj.relocs()) {
+			auto pos=bases[reloc.section]-start+reloc.offset;
+			if(addrs[reloc.symbol]!=unresolved){
+				patch(pos,addrs[reloc.symbol],reloc.kind,reloc.shift);
+			}else if(auto name=obj.name(symbols[reloc.symbol].name);globals.contains(name)){
+				patch(pos,globals[name],reloc.kind,reloc.shift);
+			}else{
+				pending.emplace_back(pos,name,reloc.kind,reloc.shift);
+			}
+		}
+	}
+	for (const auto &[pos,name,kind,shift]:pending) {
+		auto it=globals.find(name);
+		if(it==globals.end()){
+			throw std::runtime_error(std::string("undefined symbol: ")+std::string(name));
+		}
+		patch(pos,it->second,kind,shift);
+	}
+	return out;
+}
@@ -0,0 +1,70 @@
+#include "soasm/soisv1/debugger.hpp"
+#include <utility>
+
+using namespace SOASM::SOISv1;
+
+Debugger::Debugger(Context &ctx, callback_t on_hit)
+	:ctx(ctx),on_hit(std::move(on_hit)),prev_on_watch(ctx.mem.on_watch),prev_watched(ctx.mem.watched) {
+	ctx.mem.on_watch=[this](size_t addr,uint8_t v,bool write){
+		//pages watched before attaching still go to their hook
+		if(prev_on_watch && (addr>>Memory::page_bits)<prev_watched.size() && prev_watched[addr>>Memory::page_bits]){
+			prev_on_watch(addr,v,write);
+		}
+		for (const auto &w:watches) {
+			if(w.begin<=addr && addr<w.end && (write?w.write:w.read)){
+				pending.emplace_back(write?Event::Write:Event::Read,step_pc,static_cast<uint16_t>(addr),v);
+				return;
+			}
+		}
+	};
+}
+
+Debugger::~Debugger() {
+	ctx.mem.on_watch=std::move(prev_on_watch);
+	ctx.mem.watched=std::move(prev_watched);
+}
+
+void Debugger::watch(size_t begin, size_t end, bool read, bool write) {
+	watches.emplace_back(begin,end,read,write);
+	ctx.mem.watch_pages(begin,end);
+}
+
+InstrSet::record_ts Debugger::record(uint16_t pc) const {
+	auto data=ctx.mem.get_bytes<InstrSet::max_size>(pc);
+	return InstrSet::get_record(data);
+}
+
+size_t Debugger::run(size_t max_steps) {
+	halted=false;
+	//only the breakpoint that stopped the last run is passed over, so resuming does not report it again
+	auto skip=std::exchange(stopped_at,std::nullopt);
+	std::optional<InstrSet::record_ts> rec;
+	for (size_t steps=0;steps<max_steps;++steps) {
+		if(breakpoints[ctx.pc] && !(steps==0 && skip==ctx.pc))[[unlikely]]{
+			if(on_hit({Event::Breakpoint,ctx.pc,ctx.pc,0},record(ctx.pc))){
+				stopped_at=ctx.pc;
+				return steps;
+			}
+		}
+		step_pc=ctx.pc;
+		if(!watches.empty())[[unlikely]]{
+			//decoded before the step, which may overwrite the instruction
+			rec=record(step_pc);
+		}
+		halted=!ctx.run();
+		if(!pending.empty())[[unlikely]]{
+			bool stop=false;
+			for (const auto &hit:pending) {
+				stop|=on_hit(hit,*rec);
+			}
+			pending.clear();
+			if(stop){
+				return steps+1;
+			}
+		}
+		if(halted){
+			return steps+1;
+		}
+	}
+	return max_steps;
+}
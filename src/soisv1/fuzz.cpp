@@ -0,0 +1,232 @@
+#include "soasm/soisv1/fuzz.hpp"
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+using namespace SOASM::SOISv1::Fuzz;
+
+Result Target::execute(std::span<const uint8_t> input, uint8_t *coverage) const {
+	Context ctx{image};
+	ctx.pc=entry;
+	ctx.sp=sp;
+	ctx.coverage=coverage;
+	input=input.first(std::min(input.size(),max_input));
+	for (size_t i=0;i<input.size();++i) {
+		ctx.mem.set(static_cast<uint16_t>(input_addr+i),input[i]);
+	}
+	if(length_addr){
+		for (size_t i=0;auto byte:RawTypes::LE::u16::to_bytes(input.size())) {
+			ctx.mem.set(static_cast<uint16_t>(*length_addr+i++),byte);
+		}
+	}
+	for (size_t step=0;step<max_steps;++step) {
+		bool running=ctx.run();
+		if(ctx.illegal || (crashed && crashed(ctx))){
+			return Result::Crash;
+		}
+		if(!running){//pc stays on Halt, and on a Jump to itself
+			auto op=ctx.mem.get_bytes<InstrSet::raw::size>(ctx.pc);
+			return std::holds_alternative<Halt>(InstrSet::get_instr(op))?Result::Ok:Result::Hang;
+		}
+	}
+	return Result::Hang;
+}
+
+void Mutator::mutate(bytes_t &input, std::span<const uint8_t> other) {
+	static constexpr std::array<uint8_t,9> interesting8{0,1,0x7f,0x80,0xff,0x10,0x20,0x40,0x64};
+	static constexpr std::array<uint16_t,6> interesting16{0x100,0x7fff,0x8000,0xffff,0x3e8,0x1000};
+	for (size_t n=1uz<<below(5);n>0;--n) {
+		if(input.empty()){
+			input.push_back(rng());
+			continue;
+		}
+		auto pos=below(input.size());
+		switch (below(9)) {
+			case 0: input[pos]^=1u<<below(8); break;
+			case 1: input[pos]=interesting8[below(interesting8.size())]; break;
+			case 2:
+				if(pos+1<input.size()){
+					auto v=interesting16[below(interesting16.size())];
+					input[pos]=v;
+					input[pos+1]=v>>8;
+				}
+				break;
+			case 3: input[pos]+=1+below(16); break;
+			case 4: input[pos]-=1+below(16); break;
+			case 5: input[pos]=rng(); break;
+			case 6:
+				if(input.size()>1){
+					auto len=1+below(std::min<size_t>(input.size()-pos,16));
+					input.erase(input.begin()+pos,input.begin()+pos+len);
+				}
+				break;
+			case 7:
+				if(input.size()<max_input){
+					auto len=1+below(std::min(input.size()-pos,max_input-input.size()));
+					bytes_t block(input.begin()+pos,input.begin()+pos+len);
+					input.insert(input.begin()+below(input.size()+1),block.begin(),block.end());
+				}
+				break;
+			case 8:
+				if(!other.empty()){//splice
+					auto from=below(other.size());
+					auto len=1+below(std::min(other.size()-from,input.size()-pos));
+					std::copy_n(other.begin()+from,len,input.begin()+pos);
+				}
+				break;
+		}
+	}
+}
+
+Corpus::Corpus(std::vector<bytes_t> seeds):inputs(std::move(seeds)) {
+	if(inputs.empty()){
+		inputs.emplace_back(1,0);
+	}
+}
+
+uint8_t Corpus::bucket(uint8_t count) {
+	static constexpr auto table=[]{
+		std::array<uint8_t,256> t{};
+		for (size_t i=1;i<t.size();++i) {
+			t[i]=i<4?1u<<(i-1):i<8?8:i<16?16:i<32?32:i<128?64:128;
+		}
+		return t;
+	}();
+	return table[count];
+}
+
+bool Corpus::has_new(const coverage_t &coverage, Result result) const {
+	auto& seen=virgin[std::to_underlying(result)];
+	for (size_t i=0;i<coverage.size();i+=8) {
+		uint64_t word;
+		std::memcpy(&word,&coverage[i],8);
+		if(word==0){
+			continue;
+		}
+		for (size_t j=i;j<i+8;++j) {
+			if(bucket(coverage[j])&~std::atomic_ref(const_cast<uint8_t&>(seen[j])).load(std::memory_order_relaxed)){
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool Corpus::update(const coverage_t &coverage, Result result) {
+	if(!has_new(coverage,result)){
+		return false;
+	}
+	auto& seen=virgin[std::to_underlying(result)];
+	for (size_t i=0;i<coverage.size();++i) {
+		if(coverage[i]){
+			std::atomic_ref(seen[i]).fetch_or(bucket(coverage[i]),std::memory_order_relaxed);
+		}
+	}
+	return true;
+}
+
+bool Corpus::add(std::span<const uint8_t> input, const coverage_t &coverage, Result result) {
+	if(!has_new(coverage,result)){
+		return false;
+	}
+	std::lock_guard lock(mutex);//checked again under the lock, so each new bit records one input
+	if(!update(coverage,result)){
+		return false;
+	}
+	auto& list=result==Result::Ok?inputs:result==Result::Crash?crashes:hangs;
+	list.emplace_back(input.begin(),input.end());
+	return true;
+}
+
+bytes_t Corpus::pick(std::mt19937_64 &rng) const {
+	std::lock_guard lock(mutex);
+	return inputs[std::uniform_int_distribution<size_t>(0,inputs.size()-1)(rng)];
+}
+
+size_t Corpus::size() const {
+	std::lock_guard lock(mutex);
+	return inputs.size();
+}
+
+size_t Corpus::edges() const {
+	size_t count=0;
+	for (auto seen:virgin[std::to_underlying(Result::Ok)]) {
+		count+=seen!=0;
+	}
+	return count;
+}
+
+Stats Fuzz::run(const Target &target, Corpus &corpus, const Options &opts) {
+	auto coverage=std::make_unique<coverage_t>();
+	for (const auto &input:std::vector(corpus.inputs)) {
+		coverage->fill(0);
+		auto result=target.execute(input,coverage->data());
+		if(result==Result::Ok){
+			corpus.update(*coverage,result);
+		}else{
+			corpus.add(input,*coverage,result);
+		}
+	}
+
+	std::atomic<uint64_t> execs{0};
+	auto worker=[&](uint64_t seed){
+		auto coverage=std::make_unique<coverage_t>();
+		Mutator mutator(target.max_input,seed);
+		bytes_t other;
+		while(execs.fetch_add(1,std::memory_order_relaxed)<opts.max_execs){
+			auto input=corpus.pick(mutator.rng);
+			if((mutator.rng()&15)==0){
+				other=corpus.pick(mutator.rng);
+			}
+			mutator.mutate(input,other);
+			coverage->fill(0);
+			auto result=target.execute(input,coverage->data());
+			corpus.add(input,*coverage,result);
+		}
+	};
+	{
+		std::vector<std::jthread> pool;
+		for (size_t i=1;i<std::max<size_t>(opts.threads,1);++i) {
+			pool.emplace_back(worker,opts.seed+i);
+		}
+		worker(opts.seed);
+	}
+
+	if(opts.minimize){
+		for (auto &input:corpus.crashes) {
+			input=minimize(target,std::move(input),Result::Crash);
+		}
+		for (auto &input:corpus.hangs) {
+			input=minimize(target,std::move(input),Result::Hang);
+		}
+	}
+	return {opts.max_execs,corpus.size(),corpus.edges(),corpus.crashes.size(),corpus.hangs.size()};
+}
+
+bytes_t Fuzz::minimize(const Target &target, bytes_t input, Result result) {
+	auto same=[&](const bytes_t& candidate){
+		return target.execute(candidate)==result;
+	};
+	for (size_t block=std::bit_floor(std::max<size_t>(input.size(),1));block>0;block/=2) {
+		for (size_t pos=0;pos+block<=input.size();) {
+			bytes_t candidate(input.begin(),input.begin()+pos);
+			candidate.insert(candidate.end(),input.begin()+pos+block,input.end());
+			if(same(candidate)){
+				input=std::move(candidate);
+			}else{
+				pos+=block;
+			}
+		}
+	}
+	for (auto &byte:input) {
+		if(auto old=byte;old!=0){
+			byte=0;
+			if(!same(input)){
+				byte=old;
+			}
+		}
+	}
+	return input;
+}
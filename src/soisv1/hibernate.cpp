@@ -0,0 +1,149 @@
+#include "soasm/soisv1/hibernate.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+
+static_assert(std::endian::native==std::endian::little,"images are read in place");
+
+static constexpr size_t page_bits=Models::Memory<Context::mem_size>::page_bits;
+static constexpr size_t page_size=1uz<<page_bits;
+static constexpr size_t max_run=128;
+static_assert(page_size<=256,"skip counts within a page are 8 bits");
+
+static void encode_page(const std::array<uint8_t,page_size>& values,const std::array<bool,page_size>& changed,bytes_t& out){
+	for(size_t pos=0;;){
+		auto begin=pos;
+		while(begin<page_size && !changed[begin]){
+			++begin;
+		}
+		if(begin==page_size){
+			return;
+		}
+		auto skip=begin-pos;//less than page_size
+		pos=begin;
+		size_t fill=1;
+		while(pos+fill<page_size && fill<max_run && changed[pos+fill] && values[pos+fill]==values[pos]){
+			++fill;
+		}
+		if(fill>=3){
+			out.insert(out.end(),{static_cast<uint8_t>(skip),static_cast<uint8_t>(0x80|(fill-1)),values[pos]});
+			pos+=fill;
+			continue;
+		}
+		auto end=pos+1;
+		while(end<page_size && end-pos<max_run && changed[end]
+			  && !(end+2<page_size && changed[end+1] && changed[end+2] && values[end]==values[end+1] && values[end]==values[end+2])){
+			++end;
+		}
+		out.insert(out.end(),{static_cast<uint8_t>(skip),static_cast<uint8_t>(end-pos-1)});
+		out.insert(out.end(),values.begin()+pos,values.begin()+end);
+		pos=end;
+	}
+}
+
+bytes_t SOISv1::hibernate(Context &ctx) {
+	auto& mem=ctx.mem;
+	mem.restore_all();
+	Hibernated::Header header{Hibernated::magic,Hibernated::version,0,{},ctx.sp,ctx.pc,0,ctx.cycles};
+	header.flags=(ctx.CF?Hibernated::CF:0)|(ctx.illegal?Hibernated::Illegal:0);
+	std::memcpy(header.regs,ctx.reg.regs,sizeof(header.regs));
+
+	std::vector<Hibernated::Page> pages;
+	bytes_t data;
+	std::array<uint8_t,page_size> values;
+	std::array<bool,page_size> changed;
+	for(auto it=mem.overlay.begin();it!=mem.overlay.end();){
+		auto page=it->first>>page_bits;
+		changed.fill(false);
+		for(;it!=mem.overlay.end() && (it->first>>page_bits)==page;++it){
+			auto offset=it->first&(page_size-1);
+			values[offset]=it->second;
+			changed[offset]=it->second!=mem.base[it->first];
+		}
+		auto begin=data.size();
+		encode_page(values,changed,data);
+		if(data.size()>begin){
+			pages.push_back({static_cast<uint16_t>(page),static_cast<uint16_t>(data.size()-begin),static_cast<uint32_t>(begin)});
+		}
+	}
+	header.page_count=static_cast<uint32_t>(pages.size());
+	auto data_off=sizeof(Hibernated::Header)+pages.size()*sizeof(Hibernated::Page);
+	for(auto& page:pages){
+		page.offset+=data_off;
+	}
+	bytes_t blob(data_off+data.size());
+	std::memcpy(blob.data(),&header,sizeof(header));
+	std::memcpy(blob.data()+sizeof(header),pages.data(),pages.size()*sizeof(Hibernated::Page));
+	std::ranges::copy(data,blob.begin()+data_off);
+	return blob;
+}
+
+Context SOISv1::resume(const std::array<uint8_t,Context::mem_size> &base, std::shared_ptr<const bytes_t> blob) {
+	using Header=Hibernated::Header;
+	using Page=Hibernated::Page;
+	Header header;
+	if(blob->size()<sizeof(Header)){
+		throw std::invalid_argument("image truncated");
+	}
+	std::memcpy(&header,blob->data(),sizeof(Header));
+	if(header.magic!=Hibernated::magic || header.version!=Hibernated::version
+	   || blob->size()<sizeof(Header)+uintmax_t{header.page_count}*sizeof(Page)){
+		throw std::invalid_argument("not a context image");
+	}
+	std::span<const Page> pages{reinterpret_cast<const Page*>(blob->data()+sizeof(Header)),header.page_count};
+	Context ctx{base};
+	std::memcpy(ctx.reg.regs,header.regs,sizeof(header.regs));
+	ctx.sp=header.sp;
+	ctx.pc=header.pc;
+	ctx.CF=header.flags&Hibernated::CF;
+	ctx.illegal=header.flags&Hibernated::Illegal;
+	ctx.cycles=header.cycles;
+
+	auto& mem=ctx.mem;
+	mem.pending.resize(Context::mem_size>>page_bits);
+	for(const auto& page:pages){
+		if(page.page>=mem.pending.size() || page.offset+uintmax_t{page.size}>blob->size()
+		   || (&page!=pages.data() && page.page<=(&page-1)->page)){
+			throw std::invalid_argument("corrupt context image");
+		}
+		mem.pending[page.page]=true;
+	}
+	mem.pending_pages=pages.size();
+	if(pages.empty()){
+		mem.pending.clear();
+		return ctx;
+	}
+	mem.restore=[blob=std::move(blob),pages](std::map<size_t,uint8_t>& overlay,size_t page){
+		auto entry=std::ranges::lower_bound(pages,page,{},[](const Page& p){return size_t{p.page};});
+		auto data=std::span<const uint8_t>(*blob).subspan(entry->offset,entry->size);
+		auto addr=page<<page_bits;
+		auto end=addr+page_size;
+		auto hint=overlay.lower_bound(addr);
+		auto put=[&](uint8_t v){
+			if(addr<end){
+				hint=std::next(overlay.insert_or_assign(hint,addr++,v));
+			}
+		};
+		for(size_t i=0;i+1<data.size();){
+			addr+=data[i];
+			auto head=data[i+1];
+			auto length=(head&0x7fu)+1uz;
+			i+=2;
+			if(head&0x80){
+				for(size_t n=0;n<length && i<data.size();++n){
+					put(data[i]);
+				}
+				++i;
+			}else{
+				for(size_t n=0;n<length && i<data.size();++n){
+					put(data[i++]);
+				}
+			}
+		}
+	};
+	return ctx;
+}
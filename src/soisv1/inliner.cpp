@@ -0,0 +1,201 @@
+#include "soasm/soisv1/inliner.hpp"
+#include "soasm/soisv1/timing.hpp"
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+using namespace SOASM::SOISv1::Inliner;
+
+template<typename T>
+static const T* as(const instr_t& instr){
+	return std::get_if<T>(&instr.instr);
+}
+static ptrdiff_t cycles(const instr_t& instr){
+	return static_cast<ptrdiff_t>(Timing::cycles_of(instr.instr));
+}
+static ptrdiff_t bytes(const instr_t& instr){
+	return static_cast<ptrdiff_t>(instr.size());
+}
+static bool refers_to(const instr_t& instr,const Label& label){
+	return std::ranges::any_of(instr.args,[&](const Code::val_type& arg){
+		auto lazy=std::get_if<Lazy>(&arg);
+		return lazy && lazy->ptr==label.ptr;
+	});
+}
+
+namespace{
+	struct Callee{
+		decoded_t body;
+		bool frame=false;//uses Enter, Leave or Adjust
+	};
+}
+
+//body of routine, if it may be inlined
+static std::optional<Callee> inlinable(const CodeBlock& routine,const Options& opts){
+	Callee callee;
+	try{
+		callee.body=decoded_t::decode(routine.body);
+	}catch(const std::invalid_argument&){
+		return std::nullopt;
+	}
+	auto& items=callee.body.items;
+	auto last=std::ranges::find_if(items|std::views::reverse,[](const auto& item){
+		return std::holds_alternative<instr_t>(item);
+	});
+	if(last==items.rend() || !as<Return>(std::get<instr_t>(*last))){
+		return std::nullopt;
+	}
+	if(callee.body.size()-1>opts.max_size){
+		return std::nullopt;
+	}
+	std::vector<Label> labels;
+	for (const auto &item:items) {
+		if(auto label=std::get_if<Label>(&item)){
+			labels.push_back(*label);
+		}
+	}
+	for (const auto &item:items) {
+		auto instr=std::get_if<instr_t>(&item);
+		if(!instr){
+			continue;
+		}
+		if(as<Call>(*instr) || as<CallPtr>(*instr) || refers_to(*instr,routine.start) || refers_to(*instr,routine.end)){
+			return std::nullopt;
+		}
+		//a branch out of the body would return from there to the caller of the caller
+		if((as<Jump>(*instr) || as<BranchZero>(*instr))
+		   && std::ranges::none_of(labels,[&](const Label& label){return instr->refers(label,0,2);})){
+			return std::nullopt;
+		}
+		callee.frame|=as<Enter>(*instr) || as<Leave>(*instr) || as<Adjust>(*instr);
+	}
+	items.erase(std::prev(last.base()));
+	return callee;
+}
+
+//append a copy of callee to out with fresh labels, Returns jump to the end of the copy
+static void expand(const Callee& callee,std::vector<decoded_t::item_t>& out){
+	std::unordered_map<const Label::val_t*,Label> clones;
+	for (const auto &item:callee.body.items) {
+		if(auto label=std::get_if<Label>(&item)){
+			clones.try_emplace(label->ptr.get());
+		}
+	}
+	Label end;
+	bool jumps_to_end=false;
+	if(callee.frame){
+		out.emplace_back(instr_t::make(Adjust{},LE::i16{-2}));
+	}
+	auto& items=callee.body.items;
+	auto last=std::ranges::find_if(items|std::views::reverse,[](const auto& item){
+		return std::holds_alternative<instr_t>(item);
+	}).base()-items.begin()-1;
+	for (ptrdiff_t i=0;i<std::ssize(items);++i) {
+		if(auto label=std::get_if<Label>(&items[i])){
+			out.emplace_back(clones.at(label->ptr.get()));
+			continue;
+		}
+		auto instr=std::get<instr_t>(items[i]);
+		if(as<Return>(instr)){
+			if(i==last){//falls through to the end
+				continue;
+			}
+			instr=instr_t::make(Jump{},LE::u16{end});
+			jumps_to_end=true;
+		}
+		for (auto &arg:instr.args) {
+			auto lazy=std::get_if<Lazy>(&arg);
+			if(auto it=lazy?clones.find(lazy->ptr.get()):clones.end();it!=clones.end()){
+				lazy->ptr=it->second.ptr;
+			}
+		}
+		out.emplace_back(std::move(instr));
+	}
+	if(jumps_to_end){
+		out.emplace_back(end);
+	}
+	if(callee.frame){
+		out.emplace_back(instr_t::make(Adjust{},LE::i16{2}));
+	}
+}
+
+Report Inliner::optimize(std::span<CodeBlock> routines, const Options &opts) {
+	Report report;
+	std::vector<std::optional<Callee>> callees;
+	callees.reserve(routines.size());
+	for (const auto &routine:routines) {
+		callees.push_back(inlinable(routine,opts));
+	}
+	auto callee_of=[&](const instr_t& call)->std::optional<size_t>{
+		for (size_t i=0;i<routines.size();++i) {
+			if(call.refers(routines[i].start,0,2)){
+				return i;
+			}
+		}
+		return std::nullopt;
+	};
+
+	for (size_t r=0;r<routines.size();++r) {
+		decoded_t code;
+		try{
+			code=decoded_t::decode(routines[r].body);
+		}catch(const std::invalid_argument&){
+			continue;
+		}
+		bool changed=false;
+		std::vector<decoded_t::item_t> items;
+		items.reserve(code.items.size());
+		for (size_t i=0;i<code.items.size();++i) {
+			auto instr=std::get_if<instr_t>(&code.items[i]);
+			if(!instr || !as<Call>(*instr)){
+				items.push_back(code.items[i]);
+				continue;
+			}
+			if(auto c=callee_of(*instr);c && *c!=r && callees[*c]){
+				auto begin=items.size();
+				expand(*callees[*c],items);
+				report.bytes_saved+=bytes(*instr);
+				report.cycles_saved+=cycles(*instr)+cycles(instr_t::make(Return{}));
+				for (auto it=items.begin()+begin;it!=items.end();++it) {
+					if(auto added=std::get_if<instr_t>(&*it)){
+						report.bytes_saved-=bytes(*added);
+						if(as<Adjust>(*added)){//Jumps replacing a Return cost the same
+							report.cycles_saved-=cycles(*added);
+						}
+					}
+				}
+				++report.inlined;
+				++report.sites[*c];
+				changed=true;
+				continue;
+			}
+			//next instruction, labels in between are kept as other code may jump to them
+			auto next=i+1;
+			while(next<code.items.size() && std::holds_alternative<Label>(code.items[next])){
+				++next;
+			}
+			auto ret=next<code.items.size()?std::get_if<instr_t>(&code.items[next]):nullptr;
+			if(opts.tail_calls && ret && as<Return>(*ret)){
+				auto jump=instr_t{Jump{}.set_id<InstrSet>(),instr->args};
+				report.bytes_saved+=bytes(*instr)-bytes(jump);
+				report.cycles_saved+=cycles(*instr)+cycles(*ret)-cycles(jump);
+				items.push_back(std::move(jump));
+				if(next==i+1){//Return is only reached from the Call
+					report.bytes_saved+=bytes(*ret);
+					++i;
+				}
+				++report.tail_calls;
+				changed=true;
+				continue;
+			}
+			items.push_back(code.items[i]);
+		}
+		if(changed){
+			code.items=std::move(items);
+			routines[r].body=code.to_code();
+		}
+	}
+	return report;
+}
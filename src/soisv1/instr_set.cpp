@@ -6,6 +6,7 @@ using namespace SOASM::SOISv1;
 using namespace LE;
 
 template<> void Context::run_instr(Unknown instr) {
+	illegal=true;
 	pc++;
 }
 template<> void Context::run_instr(NOP instr) {
@@ -111,7 +112,14 @@ template<> void Context::run_instr(Logic instr) {
 	pc++;
 }
 template<> void Context::run_instr(BranchZero instr,uint16_t addr) {
-	pc=(pop<u8>()==0)?addr:pc+1;
+	if(pop<u8>()==0){
+		pc=addr;
+		return;
+	}
+	pc++;
+	if(coverage)[[unlikely]]{//the fall through edge, run only records transfers
+		cover();
+	}
 }
 template<> void Context::run_instr(Jump instr,uint16_t addr) {
 	pc=addr;
@@ -154,6 +162,24 @@ template<> void Context::run_instr(PopCF instr) {
 	CF= (pop<u8>() != 0);
 	pc++;
 }
+template<> void Context::run_instr(MemCopy instr) {
+	auto size=pop<u16>();
+	mem.copy(reg[instr.to],reg[instr.from],size);
+	cycles+=2*size;
+	pc++;
+}
+template<> void Context::run_instr(MemCompare instr) {
+	auto size=pop<u16>();
+	CF=mem.compare(reg[instr.from],reg[instr.to],size);
+	cycles+=2*size;
+	pc++;
+}
+template<> void Context::run_instr(MemFill instr) {
+	auto size=pop<u16>();
+	mem.fill(reg[instr.to],size,pop<u8>());
+	cycles+=size;
+	pc++;
+}
 template<> void Context::run_instr(Halt instr) {
 	// halt();
 }
@@ -1,21 +1,16 @@
 #include "soasm/soisv1/model.hpp"
+#include "soasm/interpreter.hpp"
+#include "soasm/metrics.hpp"
 
 using namespace SOASM::SOISv1;
 
 bool Context::run() {
+	SOASM_METRIC_INC(SOASM::Metrics::dispatch);
+	SOASM_METRIC_TIME_SAMPLED(SOASM::Metrics::dispatch_ns,SOASM::Metrics::sample_period);
 	auto pc_old=pc;
-	auto instr_data=mem.get_bytes<InstrSet::raw::size>(pc);
-	std::visit([&]<typename T>(T instr_obj){
-		if constexpr(0==T::args_t::num){
-			run_instr(instr_obj);
-		}else{
-			auto arg_bytes=mem.get_bytes<T::args_t::size>(pc+1);
-			auto arg_raws=T::args_t::from_bytes(arg_bytes);
-			pc+=T::args_t::size;
-			[&]<size_t ...I>(std::index_sequence<I...>){
-				run_instr(instr_obj,std::get<I>(arg_raws)...);
-			}(std::make_index_sequence<T::args_t::num>{});
-		}
-	},InstrSet::get_instr(instr_data));
+	auto size=Interpreter<InstrSet,Context,decltype(mem)>::step(*this,mem);
+	if(coverage && pc!=static_cast<uint16_t>(pc_old+size))[[unlikely]]{
+		cover();
+	}
 	return pc_old!=pc;
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "soasm/soisv1/peephole.hpp"
+#include "soasm/soisv1/timing.hpp"
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+using namespace SOASM::SOISv1::Peephole;
+
+template<typename T>
+static const T* as(const instr_t& instr){
+	return std::get_if<T>(&instr.instr);
+}
+static std::optional<uintmax_t> imm(const instr_t& instr){
+	if(as<ImmVal>(instr)){
+		return instr.value(0,1);
+	}
+	return std::nullopt;
+}
+
+const std::vector<Rule> Peephole::rules{
+	{"nop",1,[](auto w,auto&,auto&){
+		return as<NOP>(w[0])!=nullptr;
+	}},
+	{"adjust-zero",1,[](auto w,auto&,auto&){
+		return as<Adjust>(w[0]) && w[0].value(0,2)==0;
+	}},
+	{"push-pop-same",2,[](auto w,auto&,auto&){
+		auto push=as<Push>(w[0]);
+		auto pop=as<Pop>(w[1]);
+		return push && pop && push->from==pop->to;
+	}},
+	{"pushcf-popcf",2,[](auto w,auto&,auto&){
+		return as<PushCF>(w[0]) && as<PopCF>(w[1]);
+	}},
+	{"not-not",2,[](auto w,auto&,auto&){
+		auto l=as<Logic>(w[0]),r=as<Logic>(w[1]);
+		return l && r && l->fn==Logic::FN::NOT && r->fn==Logic::FN::NOT;
+	}},
+	{"logic-identity",2,[](auto w,auto&,auto&){//Logic keeps CF
+		auto v=imm(w[0]);
+		auto logic=as<Logic>(w[1]);
+		return v && logic && ((*v==0x00 && (logic->fn==Logic::FN::OR||logic->fn==Logic::FN::XOR))
+							||(*v==0xff && logic->fn==Logic::FN::AND));
+	}},
+	{"calc-identity",2,[](auto w,auto&,auto& opts){//x+0 and x-0 only differ in CF
+		auto v=imm(w[0]);
+		auto calc=as<Calc>(w[1]);
+		return opts.cf_dead && v==0 && calc && (calc->fn==Calc::FN::ADD||calc->fn==Calc::FN::SUB);
+	}},
+	{"const-branch",2,[](auto w,auto& out,auto&){
+		auto v=imm(w[0]);
+		if(!v || !as<BranchZero>(w[1])){
+			return false;
+		}
+		if(*v==0){
+			out.push_back({Jump{}.set_id<InstrSet>(),w[1].args});
+		}
+		return true;
+	}},
+};
+
+static size_t cycles(const instr_t& instr){
+	return Timing::cycles_of(instr.instr);
+}
+
+//Jump to a label that directly follows
+static bool jump_to_next(const std::vector<decoded_t::item_t>& items,size_t i){
+	auto instr=std::get_if<instr_t>(&items[i]);
+	if(!instr || !as<Jump>(*instr)){
+		return false;
+	}
+	for(++i;i<items.size();++i){
+		auto label=std::get_if<Label>(&items[i]);
+		if(!label){
+			return false;
+		}
+		if(instr->refers(*label,0,2)){
+			return true;
+		}
+	}
+	return false;
+}
+
+Report Peephole::optimize(decoded_t &code, const Options &opts) {
+	Report report;
+	std::vector<instr_t> window,replaced;
+	for (size_t pass=0;pass<opts.max_passes;++pass) {
+		bool changed=false;
+		std::vector<decoded_t::item_t> items;
+		items.reserve(code.items.size());
+		for (size_t i=0;i<code.items.size();) {
+			if(jump_to_next(code.items,i)){
+				auto& jump=std::get<instr_t>(code.items[i]);
+				report.bytes_saved+=jump.size();
+				report.cycles_saved+=cycles(jump);
+				++report.hits["jump-next"];
+				changed=true;
+				++i;
+				continue;
+			}
+			bool matched=false;
+			for (const auto &rule:rules) {
+				if(i+rule.length>code.items.size()){
+					continue;
+				}
+				window.clear();
+				for (size_t j=i;j<i+rule.length;++j) {
+					auto instr=std::get_if<instr_t>(&code.items[j]);
+					if(!instr){//labels are barriers
+						break;
+					}
+					window.push_back(*instr);
+				}
+				replaced.clear();
+				if(window.size()!=rule.length || !rule.rewrite(window,replaced,opts)){
+					continue;
+				}
+				for (const auto &instr:window) {
+					report.bytes_saved+=instr.size();
+					report.cycles_saved+=cycles(instr);
+				}
+				for (const auto &instr:replaced) {
+					report.bytes_saved-=instr.size();
+					report.cycles_saved-=cycles(instr);
+					items.emplace_back(instr);
+				}
+				++report.hits[rule.name];
+				i+=rule.length;
+				matched=changed=true;
+				break;
+			}
+			if(!matched){
+				items.push_back(code.items[i++]);
+			}
+		}
+		code.items=std::move(items);
+		if(!changed){
+			break;
+		}
+	}
+	return report;
+}
+
+Code Peephole::optimize(const Code &code, Report *report, const Options &opts) {
+	auto decoded=decoded_t::decode(code);
+	auto r=optimize(decoded,opts);
+	if(report){
+		*report=r;
+	}
+	return decoded.to_code();
+}
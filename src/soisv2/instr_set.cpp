@@ -0,0 +1,192 @@
+#include "soasm/soisv2/model.hpp"
+#include "soasm/soisv2/instr_set.hpp"
+#include <utility>
+
+using namespace SOASM::SOISv2;
+using namespace LE;
+
+template<> void Context::run_instr(Unknown instr) {
+	pc=next();
+}
+template<> void Context::run_instr(NOP instr) {
+	pc=next();
+}
+template<> void Context::run_instr(Reset instr) {
+	pc=std::to_underlying(instr.val)<<2;
+}
+
+inline std::pair<uint8_t,bool> shift_left(uint8_t v,bool carry=false){
+	return {(v<<1)|(carry?1:0),(v&0x80)!=0};
+}
+inline std::pair<uint8_t,bool> shift_right(uint8_t v,bool carry=false){
+	return {(v>>1)|(carry?0x80:0),(v&1)!=0};
+}
+inline std::pair<uint8_t,bool> add(uint8_t l,uint8_t r,bool carry=false){
+	auto res=(carry?1u:0u)+l+r;
+	return {res,(res&0x100)!=0};
+}
+inline std::pair<uint8_t,bool> sub(uint8_t l,uint8_t r,bool carry=true){
+	return add(l,~r,carry);
+}
+
+template<> void Context::run_instr(Alu instr) {
+	uint8_t lhs=reg[instr.dst],rhs=reg[instr.src],val;
+	switch (instr.fn){
+		case Alu::FN::MOV: val=rhs;break;
+		case Alu::FN::ADD: std::tie(val,CF)=add(lhs,rhs);break;
+		case Alu::FN::SUB: std::tie(val,CF)=sub(lhs,rhs);break;
+		case Alu::FN::ADC: std::tie(val,CF)=add(lhs,rhs,CF);break;
+		case Alu::FN::SUC: std::tie(val,CF)=sub(lhs,rhs,CF);break;
+		case Alu::FN::AND: val=lhs&rhs;break;
+		case Alu::FN::OR : val=lhs|rhs;break;
+		case Alu::FN::XOR: val=lhs^rhs;break;
+	}
+	reg[instr.dst]=val;
+	pc=next();
+}
+template<> void Context::run_instr(Alu16 instr) {
+	uint32_t lhs=reg[instr.dst],rhs=reg[instr.src],val=0;
+	switch (instr.fn){
+		case Alu16::FN::MOV: val=rhs;break;
+		case Alu16::FN::ADD: val=lhs+rhs;CF=(val&0x10000)!=0;break;
+		case Alu16::FN::SUB: val=lhs+(~rhs&0xffff)+1;CF=(val&0x10000)!=0;break;
+	}
+	reg[instr.dst]=static_cast<uint16_t>(val);
+	pc=next();
+}
+template<> void Context::run_instr(Unary instr) {
+	uint8_t v=reg[instr.reg];
+	switch (instr.fn){
+		case Unary::FN::NOT: v=~v;break;
+		case Unary::FN::SHL: std::tie(v,CF)=shift_left(v);break;
+		case Unary::FN::SHR: std::tie(v,CF)=shift_right(v);break;
+		case Unary::FN::RCL: std::tie(v,CF)=shift_left(v,CF);break;
+		case Unary::FN::RCR: std::tie(v,CF)=shift_right(v,CF);break;
+		case Unary::FN::INC: ++v;break;
+		case Unary::FN::DEC: --v;break;
+	}
+	reg[instr.reg]=v;
+	pc=next();
+}
+
+template<> void Context::run_instr(Imm8 instr,uint8_t val) {
+	reg[instr.dst]=val;
+	pc=next();
+}
+template<> void Context::run_instr(Imm16 instr,uint16_t val) {
+	reg[instr.dst]=val;
+	pc=next();
+}
+
+template<> void Context::run_instr(Load instr) {
+	uint16_t addr=reg[instr.addr];
+	reg[instr.dst]=mem.get(addr);
+	if(instr.mode==Load::Mode::PostInc){
+		reg[instr.addr]=addr+1;
+	}
+	pc=next();
+}
+template<> void Context::run_instr(Store instr) {
+	uint16_t addr=reg[instr.addr];
+	mem.set(addr,reg[instr.src]);
+	if(instr.mode==Store::Mode::PostInc){
+		reg[instr.addr]=addr+1;
+	}
+	pc=next();
+}
+template<> void Context::run_instr(LoadOff instr,int16_t offset) {
+	reg[instr.dst]=mem.get(static_cast<uint16_t>(reg[instr.addr]+offset));
+	pc=next();
+}
+template<> void Context::run_instr(StoreOff instr,int16_t offset) {
+	mem.set(static_cast<uint16_t>(reg[instr.addr]+offset),reg[instr.src]);
+	pc=next();
+}
+template<> void Context::run_instr(StoreImm instr,uint8_t val) {
+	mem.set(reg[instr.addr],val);
+	pc=next();
+}
+
+template<> void Context::run_instr(Push instr) {
+	push<u8>(reg[instr.from]);
+	pc=next();
+}
+template<> void Context::run_instr(Pop instr) {
+	reg[instr.to]=pop<u8>();
+	pc=next();
+}
+template<> void Context::run_instr(Push16 instr) {
+	push<u16>(reg[instr.from]);
+	pc=next();
+}
+template<> void Context::run_instr(Pop16 instr) {
+	reg[instr.to]=pop<u16>();
+	pc=next();
+}
+template<> void Context::run_instr(PushImm instr,uint8_t val) {
+	push<u8>(val);
+	pc=next();
+}
+
+template<> void Context::run_instr(BranchZero instr,uint16_t addr) {
+	pc=(reg[instr.reg]==0)?addr:next();
+}
+template<> void Context::run_instr(Jump instr,uint16_t addr) {
+	pc=addr;
+}
+template<> void Context::run_instr(Call instr,uint16_t addr) {
+	push<u16>(next());
+	pc=addr;
+}
+template<> void Context::run_instr(CallReg instr) {
+	uint16_t addr=reg[instr.addr];
+	push<u16>(next());
+	pc=addr;
+}
+template<> void Context::run_instr(Return instr) {
+	pc=pop<u16>();
+}
+
+template<> void Context::run_instr(Adjust instr,int16_t offset) {
+	sp+=offset;
+	pc=next();
+}
+template<> void Context::run_instr(Enter instr) {
+	push<u16>(reg[instr.bp]);
+	reg[instr.bp]=sp;
+	pc=next();
+}
+template<> void Context::run_instr(Leave instr) {
+	sp=reg[instr.bp];
+	reg[instr.bp]=pop<u16>();
+	pc=next();
+}
+template<> void Context::run_instr(PushCF instr) {
+	push<u8>(CF?1:0);
+	pc=next();
+}
+template<> void Context::run_instr(PopCF instr) {
+	CF= (pop<u8>() != 0);
+	pc=next();
+}
+
+template<> void Context::run_instr(MemCopy instr) {
+	uint16_t size=reg[instr.len];
+	mem.copy(reg[instr.to],reg[instr.from],size);
+	cycles+=2*size;
+	pc=next();
+}
+template<> void Context::run_instr(MemCompare instr) {
+	uint16_t size=reg[instr.len];
+	CF=mem.compare(reg[instr.from],reg[instr.to],size);
+	cycles+=2*size;
+	pc=next();
+}
+template<> void Context::run_instr(MemFill instr) {
+	uint16_t size=reg[instr.len];
+	mem.fill(reg[instr.to],size,reg[instr.val]);
+	cycles+=size;
+	pc=next();
+}
+template<> void Context::run_instr(Halt instr) {
+}
@@ -0,0 +1,13 @@
+#include "soasm/soisv2/model.hpp"
+#include "soasm/interpreter.hpp"
+#include "soasm/metrics.hpp"
+
+using namespace SOASM::SOISv2;
+
+bool Context::run() {
+	SOASM_METRIC_INC(SOASM::Metrics::dispatch);
+	SOASM_METRIC_TIME_SAMPLED(SOASM::Metrics::dispatch_ns,SOASM::Metrics::sample_period);
+	auto pc_old=pc;
+	Interpreter<InstrSet,Context,decltype(mem)>::step(*this,mem);
+	return pc_old!=pc;
+}
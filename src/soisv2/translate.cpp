@@ -0,0 +1,285 @@
+#include "soasm/soisv2/translate.hpp"
+#include "soasm/soisv2/instr_set.hpp"
+#include "soasm/soisv1/instr_set.hpp"
+#include "soasm/asm.hpp"
+#include "soasm/util/overloaded.hpp"
+#include <optional>
+#include <stdexcept>
+
+using namespace SOASM;
+using namespace SOASM::SOISv2;
+
+namespace V1=SOASM::SOISv1;
+using v1_t=Decoded<V1::InstrSet>;
+using v2_t=Decoded<InstrSet>;
+using val_t=Code::val_type;
+
+static Reg to_v2(V1::Reg reg){
+	return static_cast<Reg>(std::to_underlying(reg));
+}
+static Reg16 to_v2(V1::Reg16 reg){
+	return static_cast<Reg16>(std::to_underlying(reg));
+}
+static std::optional<Alu::FN> binary(const V1::InstrSet::instr_ts& instr){
+	if(auto calc=std::get_if<V1::Calc>(&instr)){
+		switch (calc->fn) {
+			case V1::Calc::FN::ADD: return Alu::FN::ADD;
+			case V1::Calc::FN::SUB: return Alu::FN::SUB;
+			case V1::Calc::FN::ADC: return Alu::FN::ADC;
+			case V1::Calc::FN::SUC: return Alu::FN::SUC;
+			default: return std::nullopt;
+		}
+	}
+	if(auto logic=std::get_if<V1::Logic>(&instr)){
+		switch (logic->fn) {
+			case V1::Logic::FN::AND: return Alu::FN::AND;
+			case V1::Logic::FN::OR : return Alu::FN::OR;
+			case V1::Logic::FN::XOR: return Alu::FN::XOR;
+			default: return std::nullopt;
+		}
+	}
+	return std::nullopt;
+}
+static std::optional<Unary::FN> unary(const V1::InstrSet::instr_ts& instr){
+	if(auto calc=std::get_if<V1::Calc>(&instr)){
+		switch (calc->fn) {
+			case V1::Calc::FN::SHL: return Unary::FN::SHL;
+			case V1::Calc::FN::SHR: return Unary::FN::SHR;
+			case V1::Calc::FN::RCL: return Unary::FN::RCL;
+			case V1::Calc::FN::RCR: return Unary::FN::RCR;
+			default: return std::nullopt;
+		}
+	}
+	if(auto logic=std::get_if<V1::Logic>(&instr);logic && logic->fn==V1::Logic::FN::NOT){
+		return Unary::FN::NOT;
+	}
+	return std::nullopt;
+}
+//offset(8) of SOISv1 near access as offset(16)
+static std::vector<val_t> widen(const std::vector<val_t>& args){
+	auto byte=std::get_if<uint8_t>(&args[0]);
+	if(!byte){
+		throw std::invalid_argument("near offset must not be lazy");
+	}
+	return {*byte,static_cast<uint8_t>(*byte&0x80?0xff:0x00)};
+}
+
+namespace{
+	struct Translator{
+		v2_t out{};
+		size_t folded=0;
+
+		template<typename T>
+		void emit(T instr,std::vector<val_t> args={}){
+			out.items.emplace_back(v2_t::Instr{instr.template set_id<InstrSet>(),std::move(args)});
+		}
+		void mov(Reg dst,Reg src){
+			if(dst!=src){
+				emit(Alu{.fn=Alu::FN::MOV,.dst=dst,.src=src});
+			}
+		}
+		static bool is_operand(const v1_t::Instr* instr){
+			return instr && (std::holds_alternative<V1::Push>(instr->instr)||std::holds_alternative<V1::ImmVal>(instr->instr));
+		}
+		//register holding the byte instr pushes, immediates are loaded to tmp
+		Reg operand(const v1_t::Instr& instr,Reg tmp){
+			if(auto push=std::get_if<V1::Push>(&instr.instr)){
+				return to_v2(push->from);
+			}
+			emit(Imm8{.dst=tmp},instr.args);
+			return tmp;
+		}
+		template<typename T>
+		static const T* as(const v1_t::Instr* instr){
+			return instr?std::get_if<T>(&instr->instr):nullptr;
+		}
+
+		//translate a sequence starting at w[0] in registers, return SOISv1 instructions used or 0
+		size_t fold(std::span<const v1_t::Instr* const,4> w){
+			//x y op Pop
+			if(is_operand(w[0]) && is_operand(w[1]) && w[2] && binary(w[2]->instr) && as<V1::Pop>(w[3])){
+				auto fn=*binary(w[2]->instr);
+				auto dst=to_v2(as<V1::Pop>(w[3])->to);
+				auto x=operand(*w[0],Reg::T0),y=operand(*w[1],Reg::T1);
+				if(dst==y && fn!=Alu::FN::SUB && fn!=Alu::FN::SUC){//commutative
+					std::swap(x,y);
+				}
+				if(dst!=y || dst==x){
+					mov(dst,x);
+					emit(Alu{.fn=fn,.dst=dst,.src=y});
+				}else{
+					mov(Reg::T2,x);
+					emit(Alu{.fn=fn,.dst=Reg::T2,.src=y});
+					mov(dst,Reg::T2);
+				}
+				return 4;
+			}
+			//x op Pop
+			if(is_operand(w[0]) && w[1] && unary(w[1]->instr) && as<V1::Pop>(w[2])){
+				auto dst=to_v2(as<V1::Pop>(w[2])->to);
+				mov(dst,operand(*w[0],Reg::T0));
+				emit(Unary{.fn=*unary(w[1]->instr),.reg=dst});
+				return 3;
+			}
+			if(auto pop=as<V1::Pop>(w[1]);pop && w[0]){
+				auto dst=to_v2(pop->to);
+				if(auto push=as<V1::Push>(w[0])){
+					mov(dst,to_v2(push->from));
+					return 2;
+				}
+				if(as<V1::ImmVal>(w[0])){
+					emit(Imm8{.dst=dst},w[0]->args);
+					return 2;
+				}
+				if(auto load=as<V1::Load>(w[0])){
+					emit(Load{.mode=Load::Mode::Plain,.dst=dst,.addr=to_v2(load->from)});
+					return 2;
+				}
+				if(auto load=as<V1::LoadFar>(w[0])){
+					emit(LoadOff{.dst=dst,.addr=to_v2(load->from)},w[0]->args);
+					return 2;
+				}
+				if(auto load=as<V1::LoadNear>(w[0])){
+					emit(LoadOff{.dst=dst,.addr=to_v2(load->from)},widen(w[0]->args));
+					return 2;
+				}
+			}
+			if(is_operand(w[0]) && w[1]){
+				if(auto save=as<V1::Save>(w[1])){
+					if(as<V1::ImmVal>(w[0])){
+						emit(StoreImm{.addr=to_v2(save->to)},w[0]->args);
+					}else{
+						emit(Store{.mode=Store::Mode::Plain,.src=operand(*w[0],Reg::T0),.addr=to_v2(save->to)});
+					}
+					return 2;
+				}
+				if(auto save=as<V1::SaveFar>(w[1])){
+					emit(StoreOff{.src=operand(*w[0],Reg::T0),.addr=to_v2(save->to)},w[1]->args);
+					return 2;
+				}
+				if(auto save=as<V1::SaveNear>(w[1])){
+					emit(StoreOff{.src=operand(*w[0],Reg::T0),.addr=to_v2(save->to)},widen(w[1]->args));
+					return 2;
+				}
+				if(as<V1::BranchZero>(w[1])){
+					emit(BranchZero{.reg=operand(*w[0],Reg::T0)},w[1]->args);
+					return 2;
+				}
+			}
+			return 0;
+		}
+
+		void translate(const v1_t::Instr& instr){
+			const auto& args=instr.args;
+			std::visit(Util::overloaded{
+				[&](const V1::Unknown&){throw std::invalid_argument("Unknown instruction can not be translated");},
+				[&](const V1::Reset& i){emit(Reset{.val=static_cast<Reset::Val>(std::to_underlying(i.val))});},
+				[&](const V1::LoadFar& i){
+					emit(LoadOff{.dst=Reg::T0,.addr=to_v2(i.from)},args);
+					emit(Push{.from=Reg::T0});
+				},
+				[&](const V1::LoadNear& i){
+					emit(LoadOff{.dst=Reg::T0,.addr=to_v2(i.from)},widen(args));
+					emit(Push{.from=Reg::T0});
+				},
+				[&](const V1::Load& i){
+					emit(Load{.mode=Load::Mode::Plain,.dst=Reg::T0,.addr=to_v2(i.from)});
+					emit(Push{.from=Reg::T0});
+				},
+				[&](const V1::SaveFar& i){
+					emit(Pop{.to=Reg::T0});
+					emit(StoreOff{.src=Reg::T0,.addr=to_v2(i.to)},args);
+				},
+				[&](const V1::SaveNear& i){
+					emit(Pop{.to=Reg::T0});
+					emit(StoreOff{.src=Reg::T0,.addr=to_v2(i.to)},widen(args));
+				},
+				[&](const V1::Save& i){
+					emit(Pop{.to=Reg::T0});
+					emit(Store{.mode=Store::Mode::Plain,.src=Reg::T0,.addr=to_v2(i.to)});
+				},
+				[&](const V1::SaveImm& i){emit(StoreImm{.addr=to_v2(i.to)},args);},
+				[&](const V1::Push& i){emit(Push{.from=to_v2(i.from)});},
+				[&](const V1::Pop& i){emit(Pop{.to=to_v2(i.to)});},
+				[&](const V1::ImmVal&){emit(PushImm{},args);},
+				[&]<typename T>(const T&) requires std::same_as<T,V1::Calc>||std::same_as<T,V1::Logic> {
+					if(auto fn=binary(instr.instr)){
+						emit(Pop{.to=Reg::T1});
+						emit(Pop{.to=Reg::T0});
+						emit(Alu{.fn=*fn,.dst=Reg::T0,.src=Reg::T1});
+					}else{
+						emit(Pop{.to=Reg::T0});
+						emit(Unary{.fn=*unary(instr.instr),.reg=Reg::T0});
+					}
+					emit(Push{.from=Reg::T0});
+				},
+				[&](const V1::BranchZero&){
+					emit(Pop{.to=Reg::T0});
+					emit(BranchZero{.reg=Reg::T0},args);
+				},
+				[&](const V1::Jump&){emit(Jump{},args);},
+				[&](const V1::Call&){emit(Call{},args);},
+				[&](const V1::CallPtr&){
+					emit(Pop16{.to=Reg16::T10});
+					emit(CallReg{.addr=Reg16::T10});
+				},
+				[&](const V1::Return&){emit(Return{});},
+				[&](const V1::Adjust&){emit(Adjust{},args);},
+				[&](const V1::Enter& i){emit(Enter{.bp=to_v2(i.bp)});},
+				[&](const V1::Leave& i){emit(Leave{.bp=to_v2(i.bp)});},
+				[&](const V1::PushCF&){emit(PushCF{});},
+				[&](const V1::PopCF&){emit(PopCF{});},
+				[&](const V1::MemCopy& i){
+					emit(Pop16{.to=Reg16::T10});
+					emit(MemCopy{.from=to_v2(i.from),.to=to_v2(i.to),.len=Reg16::T10});
+				},
+				[&](const V1::MemCompare& i){
+					emit(Pop16{.to=Reg16::T10});
+					emit(MemCompare{.from=to_v2(i.from),.to=to_v2(i.to),.len=Reg16::T10});
+				},
+				[&](const V1::MemFill& i){
+					emit(Pop16{.to=Reg16::T10});
+					emit(Pop{.to=Reg::T2});
+					emit(MemFill{.to=to_v2(i.to),.len=Reg16::T10,.val=Reg::T2});
+				},
+				[&](const V1::NOP&){emit(NOP{});},
+				[&](const V1::Halt&){emit(Halt{});},
+			},instr.instr);
+		}
+	};
+}
+
+Code SOISv2::translate(const Code &code, TranslateReport *report) {
+	auto in=v1_t::decode(code);
+	Translator tr;
+	size_t instrs=0;
+	for (size_t i=0;i<in.items.size();) {
+		if(auto label=std::get_if<Label>(&in.items[i])){
+			tr.out.items.emplace_back(*label);
+			++i;
+			continue;
+		}
+		std::array<const v1_t::Instr*,4> window{};
+		for (size_t k=0;k<window.size() && i+k<in.items.size();++k) {
+			window[k]=std::get_if<v1_t::Instr>(&in.items[i+k]);
+			if(!window[k]){
+				break;
+			}
+		}
+		auto used=tr.fold(window);
+		if(used>0){
+			tr.folded+=used;
+		}else{
+			tr.translate(*window[0]);
+			used=1;
+		}
+		instrs+=used;
+		i+=used;
+	}
+	if(report){
+		report->instrs_in=instrs;
+		report->instrs_out=std::ranges::count_if(tr.out.items,[](auto& item){return std::holds_alternative<v2_t::Instr>(item);});
+		report->folded=tr.folded;
+	}
+	return tr.out.to_code();
+}
@@ -0,0 +1,108 @@
+#include <soasm/symbols.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <bit>
+
+using namespace SOASM;
+
+SymbolIndex::SymbolIndex(const Label::tbl_t &labels) {
+	std::vector<std::pair<size_t,std::string_view>> symbols;
+	for (const auto &[name,label]:labels) {
+		if(auto addr=label.get();addr){
+			symbols.emplace_back(*addr,name);
+		}
+	}
+	std::ranges::stable_sort(symbols,{},[](const auto& symbol){return symbol.first;});//table is ordered by name
+	addrs.reserve(symbols.size());
+	names.reserve(symbols.size());
+	for (const auto &[addr,name]:symbols) {
+		addrs.push_back(static_cast<uint32_t>(addr));
+		names.push_back(static_cast<uint32_t>(strtab.size()));
+		strtab.append(name).push_back('\0');
+	}
+	build_blocks();
+}
+
+void SymbolIndex::build_blocks() {
+	blocks.clear();
+	if(addrs.empty()){
+		return;
+	}
+	//about one symbol per block
+	block_bits=std::bit_width(addrs.back()/addrs.size());
+	size_t count=(addrs.back()>>block_bits)+1;
+	blocks.reserve(count+1);
+	for(size_t block=0,i=0;block<=count;++block){
+		while(i<addrs.size() && (addrs[i]>>block_bits)<block){
+			++i;
+		}
+		blocks.push_back(static_cast<uint32_t>(i));
+	}
+}
+
+size_t SymbolIndex::lower_bound(size_t addr) const {
+	return std::ranges::lower_bound(addrs,addr,{},[](uint32_t v){return size_t{v};})-addrs.begin();
+}
+
+std::optional<SymbolIndex::Match> SymbolIndex::lookup(size_t addr) const {
+	if(addrs.empty() || addr<addrs.front()){
+		return std::nullopt;
+	}
+	auto i=size()-1;
+	if(auto block=addr>>block_bits;block+1<blocks.size()){
+		auto begin=addrs.begin()+blocks[block];
+		auto end=addrs.begin()+blocks[block+1];
+		i=std::ranges::upper_bound(begin,end,addr,{},[](uint32_t v){return size_t{v};})-addrs.begin()-1;
+	}
+	while(i>0 && addrs[i-1]==addrs[i]){
+		--i;
+	}
+	return Match{name(i),addr-addrs[i]};
+}
+
+bytes_t SymbolIndex::write() const {
+	static_assert(std::endian::native==std::endian::little,"map files are written in place");
+	auto align=[](size_t v){return (v+3)&~3uz;};
+	Header header{magic,version,0,static_cast<uint32_t>(size()),static_cast<uint32_t>(strtab.size()),0,0,0};
+	header.addr_off=sizeof(Header);
+	header.name_off=header.addr_off+header.count*sizeof(uint32_t);
+	header.strtab_off=header.name_off+header.count*sizeof(uint32_t);
+	bytes_t file(align(header.strtab_off+header.strtab_size),0);
+	std::memcpy(file.data(),&header,sizeof(Header));
+	std::memcpy(file.data()+header.addr_off,addrs.data(),addrs.size()*sizeof(uint32_t));
+	std::memcpy(file.data()+header.name_off,names.data(),names.size()*sizeof(uint32_t));
+	std::memcpy(file.data()+header.strtab_off,strtab.data(),strtab.size());
+	return file;
+}
+
+SymbolIndex SymbolIndex::read(std::span<const uint8_t> file) {
+	static_assert(std::endian::native==std::endian::little,"map files are read in place");
+	Header header;
+	if(file.size()<sizeof(Header)){
+		throw std::invalid_argument("map file truncated");
+	}
+	std::memcpy(&header,file.data(),sizeof(Header));
+	auto fits=[&](uint32_t offset,uint32_t count,size_t size){
+		return offset%4==0 && offset+uintmax_t{count}*size<=file.size();
+	};
+	if(header.magic!=magic || header.version!=version
+	   || !fits(header.addr_off,header.count,sizeof(uint32_t))
+	   || !fits(header.name_off,header.count,sizeof(uint32_t))
+	   || !fits(header.strtab_off,header.strtab_size,1)){
+		throw std::invalid_argument("not a map file");
+	}
+	SymbolIndex index;
+	index.addrs.resize(header.count);
+	index.names.resize(header.count);
+	std::memcpy(index.addrs.data(),file.data()+header.addr_off,header.count*sizeof(uint32_t));
+	std::memcpy(index.names.data(),file.data()+header.name_off,header.count*sizeof(uint32_t));
+	index.strtab.assign(reinterpret_cast<const char*>(file.data()+header.strtab_off),header.strtab_size);
+	if(!std::ranges::is_sorted(index.addrs)
+	   || (header.strtab_size>0 && index.strtab.back()!='\0')
+	   || std::ranges::any_of(index.names,[&](uint32_t name){return name>=header.strtab_size;})){
+		throw std::invalid_argument("corrupt map file");
+	}
+	index.build_blocks();
+	return index;
+}
@@ -1,5 +1,6 @@
 #include <soasm/types.hpp>
 #include <soasm/util/overloaded.hpp>
+#include <soasm/metrics.hpp>
 
 using namespace SOASM;
 
@@ -21,6 +22,7 @@ size_t Code::size() const {
 }
 
 data_t Code::resolve(size_t start, uint8_t padding) const {
+	SOASM_METRIC_TIME(Metrics::resolve_ns);
 	data_t data{};
 	data.reserve(size());
 	for (const auto &code:codes) {
@@ -39,11 +41,15 @@ data_t Code::resolve(size_t start, uint8_t padding) const {
 }
 
 bytes_t Code::assemble(data_t data) {
+	SOASM_METRIC_TIME(Metrics::assemble_ns);
 	bytes_t bytes;
 	bytes.reserve(data.size());
 	for (auto &code:data) {
 		bytes.emplace_back(std::visit(Util::overloaded{
-				[&](const Lazy &lazy) { return lazy(bytes.size()); },
+				[&](const Lazy &lazy) {
+					SOASM_METRIC_INC(Metrics::lazy_eval);
+					return lazy(bytes.size());
+				},
 				[&](uint8_t v) { return v; },
 		}, code));
 	}
@@ -0,0 +1,15 @@
+#ifndef SOASM_TEST_CHECK_HPP
+#define SOASM_TEST_CHECK_HPP
+
+#include <cstdlib>
+#include <iostream>
+
+//assert that also runs in release builds
+#define CHECK(cond) do{ \
+	if(!(cond)){ \
+		std::cerr<<__FILE__<<":"<<__LINE__<<": check failed: " #cond "\n"; \
+		std::exit(1); \
+	} \
+}while(0)
+
+#endif //SOASM_TEST_CHECK_HPP
@@ -0,0 +1,119 @@
+#include <soasm/soisv1.hpp>
+#include <soasm/soisv1/hibernate.hpp>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include "check.hpp"
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+
+using image_t=std::array<uint8_t,Context::mem_size>;
+
+static const image_t& base(){
+	static const image_t image=[]{
+		image_t image;
+		for(size_t i=0;i<image.size();++i){
+			image[i]=static_cast<uint8_t>(i*31+(i>>8));
+		}
+		return image;
+	}();
+	return image;
+}
+static void same_memory(const Context& lhs,const Context& rhs){
+	for(size_t addr=0;addr<Context::mem_size;++addr){
+		CHECK(lhs.mem.peek(addr)==rhs.mem.peek(addr));
+	}
+}
+//hibernate ctx, resume it and compare, both through accesses restoring single pages and through restore_all
+static void round_trip(Context& ctx){
+	auto blob=std::make_shared<const bytes_t>(hibernate(ctx));
+	auto lazy=resume(base(),blob);
+	CHECK(lazy.sp==ctx.sp && lazy.pc==ctx.pc && lazy.CF==ctx.CF && lazy.cycles==ctx.cycles);
+	CHECK(std::ranges::equal(lazy.reg.regs,ctx.reg.regs));
+	same_memory(lazy,ctx);
+	CHECK(lazy.mem.pending.empty());
+	CHECK(!lazy.mem.restore);//the closure holding the blob is dropped with the last page
+
+	auto all=resume(base(),blob);
+	all.mem.restore_all();
+	CHECK(!all.mem.restore);
+	same_memory(all,ctx);
+	CHECK(blob.use_count()==1);
+	//a resumed context hibernates to the same image
+	CHECK(hibernate(all)==*blob);
+}
+
+static void empty_overlay(){
+	Context ctx{base()};
+	ctx.pc=0x1234;
+	ctx.sp=0x8000;
+	ctx.CF=false;
+	auto blob=hibernate(ctx);
+	CHECK(blob.size()==sizeof(Hibernated::Header));
+	round_trip(ctx);
+	//bytes written back with their base value are not saved
+	ctx.mem.set(0x10,base()[0x10]);
+	CHECK(hibernate(ctx).size()==sizeof(Hibernated::Header));
+}
+static void runs(){
+	Context ctx{base()};
+	ctx.reg.regs[3]=0x77;
+	ctx.cycles=123456789;
+	ctx.illegal=true;
+	//fill runs longer than one run, crossing page ends
+	for(size_t addr=0x10f0;addr<0x1300;++addr){
+		ctx.mem.set(addr,0x55);
+	}
+	for(size_t addr=0x2000;addr<0x2100;++addr){
+		ctx.mem.set(addr,0);
+	}
+	//literal runs longer than one run and crossing a page end, mixed with short fills
+	for(size_t addr=0x30c0;addr<0x3240;++addr){
+		ctx.mem.set(addr,static_cast<uint8_t>(addr%7==0?0xaa:addr*13));
+	}
+	//single bytes at both ends of memory and of a page
+	ctx.mem.set(0,1);
+	ctx.mem.set(0x40ff,2);
+	ctx.mem.set(0x4100,3);
+	ctx.mem.set(0xffff,4);
+	round_trip(ctx);
+}
+static void rejects(){
+	Context ctx{base()};
+	for(size_t addr=0x500;addr<0x700;++addr){
+		ctx.mem.set(addr,static_cast<uint8_t>(addr));
+	}
+	auto blob=hibernate(ctx);
+	auto throws=[](bytes_t bytes){
+		try{
+			(void)resume(base(),std::make_shared<const bytes_t>(std::move(bytes)));
+		}catch(const std::invalid_argument&){
+			return true;
+		}
+		return false;
+	};
+	auto patched=[&](size_t offset,auto v){
+		auto bytes=blob;
+		std::memcpy(bytes.data()+offset,&v,sizeof(v));
+		return bytes;
+	};
+	CHECK(!throws(blob));
+	CHECK(throws({}));
+	CHECK(throws(bytes_t(blob.begin(),blob.begin()+sizeof(Hibernated::Header)-1)));
+	CHECK(throws(bytes_t(blob.begin(),blob.begin()+sizeof(Hibernated::Header)+sizeof(Hibernated::Page))));//page table cut
+	CHECK(throws(bytes_t(blob.begin(),blob.end()-1)));//page data cut
+	CHECK(throws(patched(offsetof(Hibernated::Header,magic),uint32_t{0})));
+	CHECK(throws(patched(offsetof(Hibernated::Header,version),uint16_t{Hibernated::version+1})));
+	CHECK(throws(patched(offsetof(Hibernated::Header,page_count),uint32_t{0xffffffff})));
+	auto first=sizeof(Hibernated::Header),second=first+sizeof(Hibernated::Page);
+	CHECK(throws(patched(first+offsetof(Hibernated::Page,page),uint16_t{0x100})));//past the last page
+	CHECK(throws(patched(second+offsetof(Hibernated::Page,page),uint16_t{0})));//pages not sorted
+	CHECK(throws(patched(first+offsetof(Hibernated::Page,offset),uint32_t(blob.size()))));
+}
+
+int main(){
+	empty_overlay();
+	runs();
+	rejects();
+}
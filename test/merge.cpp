@@ -0,0 +1,112 @@
+#include <soasm/soisv1.hpp>
+#include <soasm/soisv1/flow.hpp>
+#include <soasm/merge.hpp>
+#include <string>
+#include "check.hpp"
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+
+static DataBlock text(std::string_view str){
+	DataBlock block;
+	for(auto c:str){
+		block.body.push_back(static_cast<uint8_t>(c));
+	}
+	return block;
+}
+static std::string at(const bytes_t& bytes,const DataBlock& block){
+	return {bytes.begin()+*block.start.get(),bytes.begin()+*block.end.get()};
+}
+static Context run(const bytes_t& bytes){
+	static std::array<uint8_t,1<<16> mem;
+	mem.fill(0);
+	std::ranges::copy(bytes,mem.begin());
+	Context ctx{mem};
+	ctx.sp=0x8000;
+	for(int i=0;i<1000 && ctx.run();i++);
+	return ctx;
+}
+//A+=1, with a label of its own
+static CodeBlock increment(){
+	CodeBlock block;
+	Label skip;
+	block.body=Code{
+		Push{.from=Reg::A}(),ImmVal{}(1),Calc{.fn=Calc::FN::ADD}(),Pop{.to=Reg::A}(),
+		Jump{}(skip),skip,
+		Return{}(),
+	};
+	return block;
+}
+
+static void identical_routines(){
+	auto first=increment(),second=increment();
+	CodeBlock main;
+	main.body=Code{Call{}(first.start),Call{}(second.start),Halt{}()};
+	std::vector<CodeBlock> code{main,first,second};
+	auto merged=merge(code,{},ends_in_transfer<InstrSet>);
+	CHECK(merged.report.code_folded==1);
+	auto bytes=merged.assemble();
+	CHECK(*second.start.get()==*first.start.get());
+	CHECK(*second.end.get()==*first.end.get());
+	CHECK(run(bytes).reg[Reg::A]==2);
+
+	//without the report code is never folded
+	CHECK(merge(code).report.code_folded==0);
+}
+static void fall_through(){
+	//a block falling into its successor must not be folded, nor one that is fallen into
+	auto falls=[]{
+		CodeBlock block;
+		block.body=Code{Push{.from=Reg::A}(),ImmVal{}(1),Calc{.fn=Calc::FN::ADD}(),Pop{.to=Reg::A}()};
+		return block;
+	};
+	CodeBlock main,halt,empty;
+	auto first=increment(),second=falls(),after=increment();
+	main.body=Code{Call{}(first.start),Call{}(second.start),Halt{}()};
+	halt.body=Code{Halt{}()};
+	CHECK(ends_in_transfer<InstrSet>(first));
+	CHECK(!ends_in_transfer<InstrSet>(second));
+	CHECK(!ends_in_transfer<InstrSet>(empty));
+	std::vector<CodeBlock> code{main,first,halt,second,after};
+	auto merged=merge(code,{},ends_in_transfer<InstrSet>);
+	CHECK(merged.report.code_folded==0);
+	//second runs into after: A+=2 twice
+	CHECK(run(merged.assemble()).reg[Reg::A]==3);
+}
+static void suffix_chain(){
+	auto longest=text("hello world"),world=text("world"),rld=text("rld"),d=text("d"),other=text("xyz");
+	std::vector<DataBlock> data{rld,other,longest,d,world};
+	auto merged=merge({},data);
+	CHECK(merged.report.data_suffixes==3);
+	auto bytes=merged.assemble();
+	CHECK(bytes.size()==std::string_view{"hello worldxyz"}.size());
+	for(const auto& block:data){
+		std::string expected;
+		for(auto val:block.body){
+			expected+=static_cast<char>(std::get<uint8_t>(val));
+		}
+		CHECK(at(bytes,block)==expected);
+	}
+	CHECK(*d.end.get()==*longest.end.get());
+}
+static void folded_into_suffix(){
+	//world is folded into copy, which is then placed inside longest, resolving the aliases in order
+	auto copy=text("world"),world=text("world"),longest=text("hello world");
+	std::vector<DataBlock> data{copy,world,longest};
+	auto merged=merge({},data);
+	CHECK(merged.report.data_folded==1);
+	CHECK(merged.report.data_suffixes==1);
+	auto bytes=merged.assemble();
+	CHECK(bytes.size()==std::string_view{"hello world"}.size());
+	CHECK(at(bytes,world)=="world");
+	CHECK(at(bytes,copy)=="world");
+	CHECK(*world.start.get()==*copy.start.get());
+	CHECK(*world.end.get()==*longest.end.get());
+}
+
+int main(){
+	identical_routines();
+	fall_through();
+	suffix_chain();
+	folded_into_suffix();
+}
@@ -0,0 +1,136 @@
+#include <soasm/soisv1.hpp>
+#include <soasm/soisv2.hpp>
+#include <soasm/soisv2/translate.hpp>
+#include <functional>
+#include "check.hpp"
+
+using namespace SOASM;
+using namespace SOASM::SOISv1;
+
+//final state of a program, the stack below sp is left out as folded sequences do not write it
+struct State{
+	std::array<uint8_t,8> regs;
+	uint16_t sp;
+	bool CF;
+	std::array<uint8_t,0x400> data;//0x9000..
+	bool operator==(const State&) const=default;
+};
+template<typename Ctx>
+static State run(const bytes_t& bytes){
+	static std::array<uint8_t,1<<16> mem;
+	mem.fill(0);
+	std::ranges::copy(bytes,mem.begin());
+	for(size_t i=0;i<0x100;++i){
+		mem[0x9000+i]=static_cast<uint8_t>(i*7);
+	}
+	Ctx ctx{mem};
+	ctx.sp=0x8000;
+	size_t steps=0;
+	while(ctx.run()){
+		CHECK(++steps<100000);
+	}
+	State state{{},ctx.sp,ctx.CF};
+	std::ranges::copy(ctx.reg.regs|std::views::take(8),state.regs.begin());
+	ctx.mem.read(0x9000,state.data);
+	return state;
+}
+//program builds fresh labels on every call, so the SOISv1 and SOISv2 images are laid out independently
+static void same_state(const std::function<Code()>& program){
+	auto v1=run<SOISv1::Context>(program().assemble());
+	auto v2=run<SOISv2::Context>(SOISv2::translate(program()).assemble());
+	CHECK(v1==v2);
+}
+static Code set16(Reg16 reg,uint16_t v){
+	return {ImmVal{}(v&0xff),Pop{.to=Regs::toL(reg)}(),ImmVal{}(v>>8),Pop{.to=Regs::toH(reg)}()};
+}
+
+//x y op Pop in every register order, commutative and not
+static Code calc_sequences(){
+	Code code{ImmVal{}(9),Pop{.to=Reg::A}(),ImmVal{}(4),Pop{.to=Reg::B}()};
+	for(auto fn:{Calc::FN::ADD,Calc::FN::SUB,Calc::FN::ADC,Calc::FN::SUC}){
+		code.add(Code{
+			Push{.from=Reg::A}(),Push{.from=Reg::B}(),Calc{.fn=fn}(),Pop{.to=Reg::C}(),
+			Push{.from=Reg::A}(),Push{.from=Reg::B}(),Calc{.fn=fn}(),Pop{.to=Reg::B}(),
+			Push{.from=Reg::C}(),ImmVal{}(3),Calc{.fn=fn}(),Pop{.to=Reg::C}(),
+			ImmVal{}(200),Push{.from=Reg::A}(),Calc{.fn=fn}(),Pop{.to=Reg::A}(),
+			Push{.from=Reg::D}(),Push{.from=Reg::D}(),Calc{.fn=fn}(),Pop{.to=Reg::D}()
+		});
+	}
+	for(auto fn:{Logic::FN::AND,Logic::FN::OR,Logic::FN::XOR}){
+		code.add(Code{Push{.from=Reg::A}(),Push{.from=Reg::C}(),Logic{.fn=fn}(),Pop{.to=Reg::C}()});
+	}
+	code.add(Halt{}());
+	return code;
+}
+//x unary Pop, moves, loads and stores in registers
+static Code unary_moves(){
+	Code code{set16(Reg16::HL,0x9010)};
+	code.add(Code{
+		ImmVal{}(0x81),Calc{.fn=Calc::FN::SHL}(),Pop{.to=Reg::A}(),
+		Push{.from=Reg::A}(),Calc{.fn=Calc::FN::RCR}(),Pop{.to=Reg::B}(),
+		Push{.from=Reg::B}(),Logic{.fn=Logic::FN::NOT}(),Pop{.to=Reg::B}(),
+		Push{.from=Reg::A}(),Pop{.to=Reg::C}(),
+		Load{.from=Reg16::HL}(),Pop{.to=Reg::D}(),
+		LoadFar{.from=Reg16::HL}(0x20),Pop{.to=Reg::E}(),
+		LoadNear{.from=Reg16::HL}(-3),Pop{.to=Reg::F}(),
+		Push{.from=Reg::B}(),Save{.to=Reg16::HL}(),
+		ImmVal{}(0x5a),Save{.to=Reg16::HL}(),
+		Push{.from=Reg::C}(),SaveFar{.to=Reg16::HL}(0x101),
+		ImmVal{}(0x33),SaveNear{.to=Reg16::HL}(-5),
+		SaveImm{.to=Reg16::HL}(0x44),
+		Halt{}()
+	});
+	return code;
+}
+//loop with folded branch, calls and sequences that stay on the memory stack
+static Code control(){
+	Label loop,end,fn;
+	Code code{set16(Reg16::HL,0x9000)};
+	code.add(Code{
+		ImmVal{}(10),Pop{.to=Reg::A}(),ImmVal{}(0),Pop{.to=Reg::B}(),
+		loop,
+		Push{.from=Reg::A}(),BranchZero{}(end),
+		Push{.from=Reg::A}(),Push{.from=Reg::B}(),Calc{.fn=Calc::FN::ADD}(),Pop{.to=Reg::B}(),
+		Push{.from=Reg::A}(),ImmVal{}(1),Calc{.fn=Calc::FN::SUB}(),Pop{.to=Reg::A}(),
+		Jump{}(loop),
+		end,
+		Call{}(fn),
+		Push{.from=Reg::B}(),Push{.from=Reg::B}(),Calc{.fn=Calc::FN::ADD}(),SaveFar{.to=Reg16::HL}(0x80),
+		Push{.from=Reg::B}(),ImmVal{}(0),Push{.from=Reg::C}(),Calc{.fn=Calc::FN::ADD}(),Calc{.fn=Calc::FN::SUB}(),Pop{.to=Reg::E}(),
+		Halt{}(),
+		fn,
+		Push{.from=Reg::B}(),Logic{.fn=Logic::FN::NOT}(),Pop{.to=Reg::D}(),
+		ImmVal{}(0),PopCF{}(),PushCF{}(),Pop{.to=Reg::C}(),
+		Return{}()
+	});
+	return code;
+}
+//bulk instructions, with copies larger than one chunk over overlapping ranges in both directions
+//the length is pushed high byte first, as pop<u16> reads it little endian
+static Code bulk(){
+	Code code{set16(Reg16::BA,0x9000),set16(Reg16::DC,0x9010)};
+	code.add(Code{
+		ImmVal{}(0x01),ImmVal{}(0x00),MemCopy{.from=Reg16::BA,.to=Reg16::DC}(),
+		ImmVal{}(0x02),ImmVal{}(0x00),MemCopy{.from=Reg16::DC,.to=Reg16::BA}(),
+		ImmVal{}(0x20),ImmVal{}(0x00),MemCompare{.from=Reg16::BA,.to=Reg16::DC}(),PushCF{}(),Pop{.to=Reg::E}(),
+		ImmVal{}(0x6b),ImmVal{}(0x01),ImmVal{}(0x40),MemFill{.to=Reg16::DC}(),
+		ImmVal{}(0x01),ImmVal{}(0x40),MemCompare{.from=Reg16::DC,.to=Reg16::DC}(),
+		Halt{}()
+	});
+	return code;
+}
+
+int main(){
+	same_state(calc_sequences);
+	same_state(unary_moves);
+	same_state(control);
+	same_state(bulk);
+
+	//folds are taken: Push;Push;Calc;Pop is one SOISv2 instruction
+	SOISv2::TranslateReport report;
+	auto v2=SOISv2::translate(Code{Push{.from=Reg::A}(),Push{.from=Reg::B}(),Calc{.fn=Calc::FN::ADD}(),Pop{.to=Reg::A}()},&report);
+	CHECK(report.instrs_in==4);
+	CHECK(report.folded==4);
+	CHECK(report.instrs_out==1);
+	CHECK(v2.size()==SOISv2::Alu::size);
+}